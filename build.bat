@@ -26,6 +26,7 @@ SETLOCAL EnableDelayedExpansion
 ::							:: 4324	: structure was padded due to alignment specifier
 :: -wd<Number> 			= Disable a specific warning.
 :: -WX 					= Treat warnings as errors.
+:: -constexpr:steps<N>	= Raise the constant evaluation step limit, the prime tables are sieved at compile time.
 :: -FC 					= Displays the full path of source code files passed to cl.exe in diagnostic text.
 
 SET debugMode=1
@@ -37,7 +38,7 @@ SET warnings=-WX -W4 -wd4100 -wd4201 -wd4706 -wd4324
 SET includes=-Ithird_party\ -Iassets\shaders\
 SET defines=-DC_PLUS_PLUS -D_CRT_SECURE_NO_WARNINGS -DLITTLE_ENDIAN -D%platform% -DPLATFORM_ENGINE="\"%platform%\""
 SET links=
-SET flags=-std:c++20 -Zc:preprocessor -Zc:strictStrings -GR- -EHsc
+SET flags=-std:c++20 -Zc:preprocessor -Zc:strictStrings -GR- -EHsc -constexpr:steps10000000
 
 if not exist %buildDir% ( mkdir %buildDir% )
 if not exist %objectDir% ( mkdir %objectDir% )
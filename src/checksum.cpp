@@ -0,0 +1,97 @@
+struct Crc32cTables
+{
+	u32 slice[ 8 ][ 256 ];					// slice[ k ][ b ] is b followed by k zero bytes
+	bool hardware;
+};
+
+static const Crc32cTables &crc32c_tables()
+{
+	static const Crc32cTables tables = [] ()
+		{
+			Crc32cTables t;
+
+			for ( u32 b = 0; b < 256; ++b )
+			{
+				u32 crc = b;
+
+				for ( u32 bit = 0; bit < 8; ++bit )
+					crc = ( crc >> 1 ) ^ ( ( crc & 1 ) ? CRC32C_POLYNOMIAL : 0 );
+
+				t.slice[ 0 ][ b ] = crc;
+			}
+
+			for ( u32 b = 0; b < 256; ++b )
+				for ( u32 k = 1; k < 8; ++k )
+					t.slice[ k ][ b ] = ( t.slice[ k - 1 ][ b ] >> 8 ) ^ t.slice[ 0 ][ t.slice[ k - 1 ][ b ] & 0xFF ];
+
+			t.hardware = false;
+
+#ifdef CHECKSUM_HARDWARE
+#	ifdef _MSC_VER
+			int info[ 4 ];
+			__cpuid( info, 1 );
+			t.hardware = ( info[ 2 ] & BIT( 20 ) ) != 0;
+#	else
+			t.hardware = __builtin_cpu_supports( "sse4.2" );
+#	endif
+#endif
+
+			return t;
+		}();
+
+	return tables;
+}
+
+static u32 crc32c_software( const Crc32cTables &tables, u32 crc, const u8 *data, u64 size )
+{
+	for ( ; size >= sizeof( u64 ); size -= sizeof( u64 ), data += sizeof( u64 ) )
+	{
+		u64 word;
+		memcpy( &word, data, sizeof( u64 ) );
+		word ^= crc;
+
+		crc = tables.slice[ 7 ][ word & 0xFF ] ^ tables.slice[ 6 ][ ( word >> 8 ) & 0xFF ] ^
+			tables.slice[ 5 ][ ( word >> 16 ) & 0xFF ] ^ tables.slice[ 4 ][ ( word >> 24 ) & 0xFF ] ^
+			tables.slice[ 3 ][ ( word >> 32 ) & 0xFF ] ^ tables.slice[ 2 ][ ( word >> 40 ) & 0xFF ] ^
+			tables.slice[ 1 ][ ( word >> 48 ) & 0xFF ] ^ tables.slice[ 0 ][ word >> 56 ];
+	}
+
+	for ( ; size > 0; --size )
+		crc = ( crc >> 8 ) ^ tables.slice[ 0 ][ ( crc ^ *data++ ) & 0xFF ];
+
+	return crc;
+}
+
+#ifdef CHECKSUM_HARDWARE
+CHECKSUM_TARGET_SSE42 static u32 crc32c_hardware( u32 crc, const u8 *data, u64 size )
+{
+	u64 value = crc;
+
+	for ( ; size >= sizeof( u64 ); size -= sizeof( u64 ), data += sizeof( u64 ) )
+	{
+		u64 word;
+		memcpy( &word, data, sizeof( u64 ) );
+		value = _mm_crc32_u64( value, word );
+	}
+
+	for ( ; size > 0; --size )
+		value = _mm_crc32_u8( static_cast<u32>( value ), *data++ );
+
+	return static_cast<u32>( value );
+}
+#endif
+
+[[nodiscard]] u32 crc32c( u32 crc, const void *data, u64 size )
+{
+	const Crc32cTables &tables = crc32c_tables();
+	const u8 *bytes = static_cast<const u8 *>( data );
+
+	crc = ~crc;
+
+#ifdef CHECKSUM_HARDWARE
+	if ( tables.hardware )
+		return ~crc32c_hardware( crc, bytes, size );
+#endif
+
+	return ~crc32c_software( tables, crc, bytes, size );
+}
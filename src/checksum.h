@@ -0,0 +1,17 @@
+#pragma once
+
+// CRC32C (Castagnoli), with the SSE4.2 crc32 instruction when the processor has it and 8 table lookups per
+// 8 bytes otherwise.
+#if defined( _M_X64 ) || defined( __x86_64__ )
+#	define CHECKSUM_HARDWARE
+#	ifdef _MSC_VER
+#		define CHECKSUM_TARGET_SSE42
+#	else
+#		define CHECKSUM_TARGET_SSE42 __attribute__( ( target( "sse4.2" ) ) )
+#	endif
+#endif
+
+#define CRC32C_POLYNOMIAL						( 0x82F63B78u )		// reflected
+
+/// @desc Carries crc on over size more bytes, crc32c( crc32c( 0, a ), b ) is the checksum of a then b
+[[nodiscard]] u32 crc32c( u32 crc, const void *data, u64 size );
@@ -22,6 +22,13 @@
 #define INVALID_INDEX_UINT_64						( UINT64_MAX )
 
 #define PRIME_NUMBER_FILE							"prime_numbers.bin"
+#define PRIME_RANGE_FILE							"prime_range.bin"
+#define PRIME_BITMAP_FILE							"prime_bitmap.bin"
+#define PRIME_MANIFEST_FILE							"prime_manifest.txt"
+#define PRIME_SHARD_FILE							"prime_shard_%u.bin"
+#define SIEVE_TUNING_FILE							"sieve_tuning.txt"
+#define PRIME_STATS_FILE							"prime_stats.txt"
+#define PRIME_TUPLE_FILE							"prime_%s.bin"
 
 #define INVALID_FILE_INDEX							( INVALID_INDEX_UINT_32 )
 #define MAX_OPEN_FILES								( 8 )
@@ -31,6 +38,22 @@
 #define MAX_LOG_FILES								( 16 )
 #define MAX_DEBUG_MESSAGE							( 4096 )
 #define MAX_CONVERT_TO_STRING_DIGITS				( 32 )
+#define MAX_CONVERT_TO_STRING_DIGITS_128			( 129 )		// a u128 in binary and the terminator
+
+#define MAX_THREADS_PER_CORE						( 4ull )
+#define DEFAULT_SIEVE_SEGMENT_BYTES					( KB( 32 ) )
+#define SIEVE_SMALL_PRIMES_DIRECT_LIMIT				( 1u << 20 )
+#define SIEVE_CHUNK_BYTES							( MB( 2 ) )		// of sieve bytes, what a chunk slot holds follows from this
+#define DEFAULT_FILE_WRITER_BLOCK					( MB( 1 ) )
+#define MAX_FILE_WRITER_BLOCK						( MB( 1024 ) )
+#define FILE_WRITER_BLOCK_COUNT						( 4 )
+#define PRIME_FILE_CHECKPOINT_PRIMES				( 1ull << 24 )
+#define PRIME_FILE_MAGIC							( 0x454C494650495250ull )	// "PRIPFILE"
+#define PRIME_FILE_VERSION							( 1 )
+#define PRIME_FILE_ENDIAN_TAG						( 0x01020304u )		// reads back as 0x04030201 with the other byte order
+#define PRIME_FILE_CHECKSUM_BLOCK					( MB( 1 ) )
+#define PRIME_GAP_BLOCK_BYTES						( KB( 4 ) )
+#define FACTORISE_TRIAL_LIMIT						( 1u << 12 )		// rho is faster past this
 
 using i8  = int8_t;
 using i16 = int16_t;
@@ -0,0 +1,325 @@
+// A point on the curve by its x coordinate, X / Z in Montgomery form
+struct EcmPoint
+{
+	u128 x;
+	u128 z;
+};
+
+struct EcmCurve
+{
+	const Montgomery128 *montgomery;
+	u128 a24;								// ( A + 2 ) / 4 in Montgomery form
+};
+
+// Shared by the threads, the tables are read only once the curves start
+struct Ecm
+{
+	Montgomery128 montgomery;
+	std::vector<u32> primes;				// odd primes up to the last B2
+	std::vector<u8> prime;					// index i is whether 2i + 1 is prime, up to the last B2 and a giant step
+
+	std::mutex mutex;
+	u32 nextCurve;							// curves handed out so far, counted across ECM_LEVELS
+	u128 factor;							// 0 until a curve finds one
+};
+
+/// @desc 2p
+[[nodiscard]] static inline EcmPoint ecm_double( const EcmCurve *curve, EcmPoint p )
+{
+	const Montgomery128 *montgomery = curve->montgomery;
+
+	u128 sum = montgomery_add( montgomery, p.x, p.z );
+	u128 difference = montgomery_subtract( montgomery, p.x, p.z );
+	u128 sumSquared = montgomery_multiply( montgomery, sum, sum );
+	u128 differenceSquared = montgomery_multiply( montgomery, difference, difference );
+
+	// ( X + Z )^2 - ( X - Z )^2 = 4 X Z
+	u128 cross = montgomery_subtract( montgomery, sumSquared, differenceSquared );
+	u128 z = montgomery_add( montgomery, differenceSquared, montgomery_multiply( montgomery, curve->a24, cross ) );
+
+	return { montgomery_multiply( montgomery, sumSquared, differenceSquared ), montgomery_multiply( montgomery, cross, z ) };
+}
+
+/// @desc p + q, difference being p - q
+[[nodiscard]] static inline EcmPoint ecm_add( const Montgomery128 *montgomery, EcmPoint p, EcmPoint q, EcmPoint difference )
+{
+	u128 u = montgomery_multiply( montgomery, montgomery_subtract( montgomery, p.x, p.z ), montgomery_add( montgomery, q.x, q.z ) );
+	u128 v = montgomery_multiply( montgomery, montgomery_add( montgomery, p.x, p.z ), montgomery_subtract( montgomery, q.x, q.z ) );
+	u128 sum = montgomery_add( montgomery, u, v );
+	u128 difference2 = montgomery_subtract( montgomery, u, v );
+
+	return { montgomery_multiply( montgomery, difference.z, montgomery_multiply( montgomery, sum, sum ) ),
+			 montgomery_multiply( montgomery, difference.x, montgomery_multiply( montgomery, difference2, difference2 ) ) };
+}
+
+/// @desc kp for k of 2 or more, by the Montgomery ladder: low and high stay p apart
+[[nodiscard]] static EcmPoint ecm_multiply( const EcmCurve *curve, EcmPoint p, u64 k )
+{
+	EcmPoint low = p;
+	EcmPoint high = ecm_double( curve, p );
+
+	for ( u32 bit = 62 - count_leading_zeros( k ); bit < 64; --bit )
+	{
+		if ( ( k >> bit ) & 1 )
+		{
+			low = ecm_add( curve->montgomery, high, low, p );
+			high = ecm_double( curve, high );
+		}
+		else
+		{
+			high = ecm_add( curve->montgomery, high, low, p );
+			low = ecm_double( curve, low );
+		}
+	}
+
+	return low;
+}
+
+/// @desc value^-1 mod the modulus by the binary extended gcd, for a value that is not in Montgomery form
+/// @return The inverse, 0 when there is none and the gcd of value and the modulus is written to divisor
+[[nodiscard]] static u128 ecm_inverse( const Montgomery128 *montgomery, u128 value, u128 *divisor )
+{
+	u128 modulus = montgomery->modulus;
+	u128 half = ( modulus >> 1 ) + 1;		// 2^-1, the modulus is odd
+
+	// x * value = u and y * value = v mod the modulus throughout
+	u128 u = value;
+	u128 v = modulus;
+	u128 x = 1;
+	u128 y = 0;
+
+	while ( u != 0 )
+	{
+		while ( ( u.low & 1 ) == 0 )
+		{
+			u >>= 1;
+			x = ( x.low & 1 ) ? ( x >> 1 ) + half : x >> 1;
+		}
+
+		if ( u < v )
+		{
+			u128 swap = u;
+			u = v;
+			v = swap;
+
+			swap = x;
+			x = y;
+			y = swap;
+		}
+
+		u -= v;
+		x = montgomery_subtract( montgomery, x, y );
+	}
+
+	*divisor = v;
+
+	return ( v == 1 ) ? y : u128( 0 );
+}
+
+/// @return true when another thread has found a factor
+[[nodiscard]] static bool ecm_stopped( Ecm *ecm )
+{
+	std::lock_guard<std::mutex> lock( ecm->mutex );
+	return ecm->factor != 0;
+}
+
+/// @desc Runs curve sigma with stage 1 to b1 and stage 2 to b1 * ECM_STAGE2_MULTIPLIER
+/// @return A factor, 0 when the curve found none
+[[nodiscard]] static u128 ecm_curve( Ecm *ecm, u64 sigma, u32 b1 )
+{
+	const Montgomery128 *montgomery = &ecm->montgomery;
+	u128 value = montgomery->modulus;
+
+	// Suyama: u = sigma^2 - 5, v = 4 sigma, the point is u^3 : v^3 and ( A + 2 ) / 4 = ( v - u )^3 ( 3u + v ) / 16 u^3 v
+	u128 s = montgomery_to( montgomery, sigma );
+	u128 u = montgomery_subtract( montgomery, montgomery_multiply( montgomery, s, s ), montgomery_to( montgomery, 5 ) );
+	u128 v = montgomery_add( montgomery, s, s );
+	v = montgomery_add( montgomery, v, v );
+
+	u128 uCubed = montgomery_multiply( montgomery, montgomery_multiply( montgomery, u, u ), u );
+	u128 vCubed = montgomery_multiply( montgomery, montgomery_multiply( montgomery, v, v ), v );
+	u128 vu = montgomery_subtract( montgomery, v, u );
+	u128 threeUV = montgomery_add( montgomery, montgomery_add( montgomery, montgomery_add( montgomery, u, u ), u ), v );
+	u128 numerator = montgomery_multiply( montgomery, montgomery_multiply( montgomery, montgomery_multiply( montgomery, vu, vu ), vu ), threeUV );
+	u128 denominator = montgomery_multiply( montgomery, montgomery_multiply( montgomery, uCubed, v ), montgomery_to( montgomery, 16 ) );
+
+	u128 divisor;
+	u128 inverse = ecm_inverse( montgomery, montgomery_from( montgomery, denominator ), &divisor );
+
+	// A bad sigma for this value, unless the gcd happened on a factor
+	if ( divisor != 1 )
+		return ( divisor != value ) ? divisor : u128( 0 );
+
+	EcmCurve curve = { montgomery, montgomery_multiply( montgomery, numerator, montgomery_to( montgomery, inverse ) ) };
+	EcmPoint point = { uCubed, vCubed };
+
+	// Stage 1, the prime powers up to b1 are gathered into a u64 per ladder
+	for ( u64 power = 2; power <= b1; power *= 2 )
+		point = ecm_double( &curve, point );
+
+	u64 multiplier = 1;
+
+	for ( u32 p : ecm->primes )
+	{
+		if ( p > b1 )
+			break;
+
+		u64 power = p;
+		while ( power * p <= b1 )
+			power *= p;
+
+		if ( multiplier > UINT64_MAX / power )
+		{
+			point = ecm_multiply( &curve, point, multiplier );
+			multiplier = 1;
+		}
+
+		multiplier *= power;
+	}
+
+	if ( multiplier > 1 )
+		point = ecm_multiply( &curve, point, multiplier );
+
+	divisor = greatest_common_divisor( point.z, value );
+
+	if ( divisor != 1 )
+		return ( divisor != value ) ? divisor : u128( 0 );
+
+	if ( ecm_stopped( ecm ) )
+		return 0;
+
+	// Stage 2, the odd baby steps b below D / 2 with no factor in common with D
+	u64 b2 = static_cast<u64>( b1 ) * ECM_STAGE2_MULTIPLIER;
+	u32 babyCount = 0;
+	u32 babySteps[ ECM_GIANT_STEP / 2 ];
+	EcmPoint babies[ ECM_GIANT_STEP / 2 ];
+
+	EcmPoint twice = ecm_double( &curve, point );
+	EcmPoint previous = point;
+	EcmPoint current = ecm_add( montgomery, twice, point, point );
+
+	babySteps[ babyCount ] = 1;
+	babies[ babyCount++ ] = point;
+
+	for ( u32 b = 3; b < ECM_GIANT_STEP / 2; b += 2 )
+	{
+		if ( b % 3 && b % 5 && b % 7 && b % 11 )
+		{
+			babySteps[ babyCount ] = b;
+			babies[ babyCount++ ] = current;
+		}
+
+		EcmPoint next = ecm_add( montgomery, current, twice, previous );
+		previous = current;
+		current = next;
+	}
+
+	// Giant steps k D, one product of X_g Z_b - X_b Z_g for each pair with k D - b or k D + b prime
+	EcmPoint giant = ecm_multiply( &curve, point, ECM_GIANT_STEP );
+	EcmPoint step = giant;
+	EcmPoint before = giant;
+	u128 product = montgomery->one;
+
+	for ( u64 k = 1; k * ECM_GIANT_STEP <= b2 + ECM_GIANT_STEP / 2; ++k )
+	{
+		u64 centre = k * ECM_GIANT_STEP;
+
+		if ( centre + ECM_GIANT_STEP / 2 > b1 )
+		{
+			for ( u32 i = 0; i < babyCount; ++i )
+			{
+				u64 below = centre - babySteps[ i ];
+				u64 above = centre + babySteps[ i ];
+
+				bool used = ( below > b1 && below <= b2 && ecm->prime[ below / 2 ] ) || ( above > b1 && above <= b2 && ecm->prime[ above / 2 ] );
+
+				if ( !used )
+					continue;
+
+				u128 difference = montgomery_subtract( montgomery, montgomery_multiply( montgomery, giant.x, babies[ i ].z ),
+													   montgomery_multiply( montgomery, babies[ i ].x, giant.z ) );
+				product = montgomery_multiply( montgomery, product, difference );
+			}
+		}
+
+		// ( k + 1 ) D from k D, D and ( k - 1 ) D, the first is a doubling
+		EcmPoint next = ( k == 1 ) ? ecm_double( &curve, giant ) : ecm_add( montgomery, giant, step, before );
+		before = giant;
+		giant = next;
+	}
+
+	divisor = greatest_common_divisor( product, value );
+
+	return ( divisor != value ) && ( divisor != 1 ) ? divisor : u128( 0 );
+}
+
+static void ecm_worker( Ecm *ecm )
+{
+	for ( ;; )
+	{
+		u32 curve;
+
+		{
+			std::lock_guard<std::mutex> lock( ecm->mutex );
+
+			if ( ecm->factor != 0 )
+				return;
+
+			curve = ecm->nextCurve++;
+		}
+
+		// The level this curve belongs to
+		u32 first = 0;
+		u32 level = 0;
+
+		for ( ; level < ECM_LEVEL_COUNT && curve >= first + ECM_LEVELS[ level ].curves; ++level )
+			first += ECM_LEVELS[ level ].curves;
+
+		if ( level == ECM_LEVEL_COUNT )
+			return;
+
+		// sigma 6 onwards, every one a curve of its own
+		u128 factor = ecm_curve( ecm, 6 + curve, ECM_LEVELS[ level ].b1 );
+
+		if ( factor != 0 )
+		{
+			std::lock_guard<std::mutex> lock( ecm->mutex );
+
+			if ( ecm->factor == 0 )
+				ecm->factor = factor;
+
+			return;
+		}
+	}
+}
+
+u128 ecm_find_factor( u128 value, u32 threadCount )
+{
+	massert( ( value.low & 1 ) && value > 1 );
+
+	Ecm ecm;
+	montgomery_initialise( &ecm.montgomery, value );
+	ecm.nextCurve = 0;
+	ecm.factor = 0;
+
+	u32 lastB1 = ECM_LEVELS[ ECM_LEVEL_COUNT - 1 ].b1;
+	u32 limit = lastB1 * ECM_STAGE2_MULTIPLIER + ECM_GIANT_STEP;
+
+	sieve_small_primes( limit, ecm.primes );
+
+	ecm.prime.assign( limit / 2 + 1, 0 );
+	for ( u32 p : ecm.primes )
+		ecm.prime[ p / 2 ] = 1;
+
+	std::vector<std::thread> workers;
+
+	for ( u32 i = 1; i < threadCount; ++i )
+		workers.emplace_back( ecm_worker, &ecm );
+
+	ecm_worker( &ecm );
+
+	for ( std::thread &worker : workers )
+		worker.join();
+
+	return ecm.factor;
+}
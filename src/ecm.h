@@ -0,0 +1,26 @@
+#pragma once
+
+// Lenstra's elliptic curve method, for the 128 bit cofactors whose smallest factor is too large for rho and that
+// the quadratic sieve cannot split.
+// Each curve is a Montgomery curve B y^2 = x^3 + A x^2 + x from Suyama's parametrisation of sigma (its order has 12
+// as a factor), worked on the x coordinate alone as X : Z in 128 bit Montgomery arithmetic so no inverse is needed
+// past setting it up. Stage 1 multiplies a point by every prime power up to B1 with the Montgomery ladder, a factor
+// turns up when the order of the curve mod one prime of the value has nothing larger. Stage 2 allows one more prime
+// q up to B2, written as k D +- b it is found by comparing the giant step k D with the baby step b.
+// The curves are handed out across the threads in order of ECM_LEVELS, the first factor found stops them all.
+#define ECM_STAGE2_MULTIPLIER					( 100 )				// B2 = B1 * this
+#define ECM_GIANT_STEP							( 2310 )			// D, 2 * 3 * 5 * 7 * 11 leaves 240 baby steps up to D / 2
+#define ECM_LEVEL_COUNT							( 3 )
+
+struct EcmLevel
+{
+	u32 b1;
+	u32 curves;
+};
+
+// Curves at each B1 before moving up, enough to expect the factors of 15, 20 and 25 digits
+inline constexpr EcmLevel ECM_LEVELS[ ECM_LEVEL_COUNT ] = { { 2000, 25 }, { 11000, 90 }, { 50000, 300 } };
+
+/// @desc Finds a factor of an odd composite value with no small factors, with up to threadCount curves at a time
+/// @return A factor between 1 and value (exclusive), 0 when none turned up on the curves of ECM_LEVELS
+[[nodiscard]] u128 ecm_find_factor( u128 value, u32 threadCount );
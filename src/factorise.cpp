@@ -0,0 +1,311 @@
+// Anything left after the trial division below this has no factor under its square root, so it is prime
+static constexpr u64 FACTORISE_TRIAL_SQUARE = static_cast<u64>( FACTORISE_TRIAL_LIMIT + 1 ) * ( FACTORISE_TRIAL_LIMIT + 1 );
+
+[[nodiscard]] static u64 greatest_common_divisor( u64 a, u64 b )
+{
+	if ( a == 0 )
+		return b;
+
+	if ( b == 0 )
+		return a;
+
+	// Binary gcd, the shared powers of 2 are put back at the end
+	u32 shift = count_trailing_zeros( a | b );
+	a >>= count_trailing_zeros( a );
+
+	while ( b )
+	{
+		b >>= count_trailing_zeros( b );
+
+		if ( a > b )
+		{
+			u64 swap = a;
+			a = b;
+			b = swap;
+		}
+
+		b -= a;
+	}
+
+	return a << shift;
+}
+
+u64 pollard_brent( u64 value )
+{
+	Montgomery montgomery;
+	montgomery_initialise( &montgomery, value );
+
+	// x -> x^2 + c, c is moved on when a cycle closes without finding a factor
+	for ( u64 c = 1; ; ++c )
+	{
+		u64 increment = montgomery_to( &montgomery, c );
+		u64 y = montgomery_to( &montgomery, 2 );
+		u64 x = y;
+		u64 saved = y;
+		u64 product = montgomery.one;
+		u64 divisor = 1;
+
+		auto step = [&] ( u64 v )
+			{
+				v = montgomery_multiply( &montgomery, v, v );
+				return ( v >= value - increment ) ? v - ( value - increment ) : v + increment;
+			};
+
+		for ( u64 length = 1; divisor == 1; length <<= 1 )
+		{
+			x = y;
+
+			for ( u64 i = 0; i < length; ++i )
+				y = step( y );
+
+			for ( u64 done = 0; done < length && divisor == 1; done += FACTORISE_RHO_BATCH )
+			{
+				saved = y;
+
+				for ( u64 i = 0; i < FACTORISE_RHO_BATCH && done + i < length; ++i )
+				{
+					y = step( y );
+					product = montgomery_multiply( &montgomery, product, ( x > y ) ? x - y : y - x );
+				}
+
+				divisor = greatest_common_divisor( product, value );
+			}
+		}
+
+		// The batch overshot, step through it again one difference at a time
+		if ( divisor == value )
+		{
+			do
+			{
+				saved = step( saved );
+				divisor = greatest_common_divisor( ( x > saved ) ? x - saved : saved - x, value );
+
+			} while ( divisor == 1 );
+		}
+
+		if ( divisor != value )
+			return divisor;
+	}
+}
+
+static void factorise_cofactor( u64 value, std::vector<u64> &factors )
+{
+	if ( value < FACTORISE_TRIAL_SQUARE || is_prime( value ) )
+	{
+		factors.push_back( value );
+		return;
+	}
+
+	u64 divisor = pollard_brent( value );
+
+	factorise_cofactor( divisor, factors );
+	factorise_cofactor( value / divisor, factors );
+}
+
+void factorise( u64 value, std::vector<u64> &factors )
+{
+	factors.clear();
+
+	if ( value < 2 )
+		return;
+
+	for ( u32 twos = count_trailing_zeros( value ); twos > 0; --twos )
+		factors.push_back( 2 );
+
+	value >>= count_trailing_zeros( value );
+
+	u64 p = 2;
+
+	// Trial division by the built in primes, a multiply and a compare each rather than a division
+	for ( u32 i = 0; i < SMALL_PRIMES.COUNT; ++i )
+	{
+		p = SMALL_PRIMES.primes[ i ];
+
+		if ( p > FACTORISE_TRIAL_LIMIT || p * p > value )
+			break;
+
+		const TrialDivisor &divisor = SMALL_PRIMES.divisors[ i ];
+
+		while ( trial_divides( divisor, value ) )
+		{
+			factors.push_back( p );
+			value = trial_divide_exact( divisor, value );
+		}
+	}
+
+	// Once past the square root of what is left, it is prime. Beyond the limit rho finds factors faster.
+	if ( value > 1 )
+	{
+		if ( p * p > value )
+			factors.push_back( value );
+		else
+			factorise_cofactor( value, factors );
+	}
+
+	std::sort( factors.begin(), factors.end() );
+}
+
+// -------------------------------------------------------------------------
+// 128 bit
+
+u128 pollard_brent( u128 value, u64 steps )
+{
+	Montgomery128 montgomery;
+	montgomery_initialise( &montgomery, value );
+
+	u64 taken = 0;
+
+	// As the u64 version, counting the steps taken across every c
+	for ( u64 c = 1; taken < steps; ++c )
+	{
+		u128 increment = montgomery_to( &montgomery, c );
+		u128 y = montgomery_to( &montgomery, 2 );
+		u128 x = y;
+		u128 saved = y;
+		u128 product = montgomery.one;
+		u128 divisor = 1;
+
+		auto step = [&] ( u128 v )
+			{
+				return montgomery_add( &montgomery, montgomery_multiply( &montgomery, v, v ), increment );
+			};
+
+		for ( u64 length = 1; divisor == 1 && taken < steps; length <<= 1 )
+		{
+			x = y;
+
+			for ( u64 i = 0; i < length; ++i )
+				y = step( y );
+
+			for ( u64 done = 0; done < length && divisor == 1; done += FACTORISE_RHO_BATCH )
+			{
+				saved = y;
+
+				for ( u64 i = 0; i < FACTORISE_RHO_BATCH && done + i < length; ++i )
+				{
+					y = step( y );
+					product = montgomery_multiply( &montgomery, product, ( x > y ) ? x - y : y - x );
+				}
+
+				divisor = greatest_common_divisor( product, value );
+			}
+
+			taken += 2 * length;
+		}
+
+		if ( divisor == 1 )
+			return 0;
+
+		// The batch overshot, step through it again one difference at a time
+		if ( divisor == value )
+		{
+			do
+			{
+				saved = step( saved );
+				divisor = greatest_common_divisor( ( x > saved ) ? x - saved : saved - x, value );
+
+			} while ( divisor == 1 );
+		}
+
+		if ( divisor != value )
+			return divisor;
+	}
+
+	return 0;
+}
+
+/// @desc value has no factor up to FACTORISE_TRIAL_LIMIT
+/// @return false when a composite was left unsplit
+static bool factorise_cofactor( u128 value, std::vector<u128> &factors, u32 threadCount )
+{
+	if ( value.high == 0 )
+	{
+		std::vector<u64> narrow;
+		factorise_cofactor( value.low, narrow );
+		factors.insert( factors.end(), narrow.begin(), narrow.end() );
+		return true;
+	}
+
+	if ( is_prime( value ) )
+	{
+		factors.push_back( value );
+		return true;
+	}
+
+	u128 divisor = pollard_brent( value, FACTORISE_RHO_128_STEPS );
+
+	// Neither the sieve nor the curves are any quicker on a square, which the root gives straight away
+	if ( divisor == 0 )
+	{
+		u64 root = integer_sqrt( value );
+
+		if ( u128( root ) * root == value )
+			divisor = root;
+	}
+
+	// The sieve takes about the same time whatever the factors, the curves are left for what it cannot split (prime powers)
+	if ( divisor == 0 )
+		divisor = siqs_find_factor( value, threadCount );
+
+	if ( divisor == 0 )
+		divisor = ecm_find_factor( value, threadCount );
+
+	if ( divisor == 0 )
+	{
+		factors.push_back( value );
+		return false;
+	}
+
+	bool split = factorise_cofactor( divisor, factors, threadCount );
+	split = factorise_cofactor( value / divisor, factors, threadCount ) && split;
+
+	return split;
+}
+
+bool factorise( u128 value, std::vector<u128> &factors, u32 threadCount )
+{
+	factors.clear();
+
+	bool complete = true;
+	std::vector<u64> narrow;
+
+	if ( value.high != 0 )
+	{
+		u32 twos = count_trailing_zeros( value );
+		factors.insert( factors.end(), twos, u128( 2 ) );
+		value >>= twos;
+
+		// Trial division while it is too wide for the u64 version, which takes over once it fits
+		for ( u32 i = 0; i < SMALL_PRIMES.COUNT && value.high != 0; ++i )
+		{
+			u64 p = SMALL_PRIMES.primes[ i ];
+
+			if ( p > FACTORISE_TRIAL_LIMIT )
+				break;
+
+			u128 remainder;
+			u128 quotient = divide( value, p, &remainder );
+
+			while ( remainder == 0 )
+			{
+				factors.push_back( p );
+				value = quotient;
+				quotient = divide( value, p, &remainder );
+			}
+		}
+	}
+
+	if ( value.high == 0 )
+	{
+		factorise( value.low, narrow );
+		factors.insert( factors.end(), narrow.begin(), narrow.end() );
+	}
+	else
+	{
+		complete = factorise_cofactor( value, factors, threadCount );
+	}
+
+	std::sort( factors.begin(), factors.end() );
+
+	return complete;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Factorisation of any u64 without a prime table.
+// Trial division by the built in odd primes up to FACTORISE_TRIAL_LIMIT, then whatever is left is either
+// prime (Miller-Rabin) or split with Brent's variant of Pollard's rho, taking the gcd of a batch of differences at a time.
+#define FACTORISE_RHO_BATCH						( 128 )
+#define FACTORISE_RHO_128_STEPS					( 1ull << 16 )		// rho hands a 128 bit cofactor on to the sieve after this many
+
+/// @desc Writes the prime factors of value (with repeats) into factors in ascending order, nothing for 0 and 1
+void factorise( u64 value, std::vector<u64> &factors );
+
+/// @desc Finds a factor of an odd composite value
+/// @return A factor between 1 and value (exclusive)
+[[nodiscard]] u64 pollard_brent( u64 value );
+
+// A u128 goes the same way until what is left fits a u64, the cofactors above that are tested with Baillie-PSW and
+// split by rho in 128 bit Montgomery arithmetic. Rho finds factors up to about 2^32 in FACTORISE_RHO_128_STEPS, the
+// self-initialising quadratic sieve takes over past that and the elliptic curve method gets what the sieve cannot
+// split, both spread across threadCount threads.
+
+/// @desc Writes the prime factors of value (with repeats) into factors in ascending order, nothing for 0 and 1
+/// @return false when a composite cofactor was left unsplit, it is among the factors
+bool factorise( u128 value, std::vector<u128> &factors, u32 threadCount = 1 );
+
+/// @desc Finds a factor of an odd composite value within steps iterations
+/// @return A factor between 1 and value (exclusive), 0 when none turned up
+[[nodiscard]] u128 pollard_brent( u128 value, u64 steps );
@@ -0,0 +1,274 @@
+#pragma once
+
+// An unsigned 128 bit integer. MSVC has no 128 bit type, so it is two u64 halves with the arithmetic written out
+// on them, multiply_128 and divide_128 taking the wide steps. It converts from a u64 but never back on its own.
+struct u128
+{
+	u64 low;
+	u64 high;
+
+	u128() = default;
+	constexpr u128( u64 value ) : low( value ), high( 0 ) {}
+	constexpr u128( u64 highHalf, u64 lowHalf ) : low( lowHalf ), high( highHalf ) {}
+};
+
+inline constexpr u128 U128_MAX = u128( UINT64_MAX, UINT64_MAX );
+
+[[nodiscard]] constexpr inline bool operator==( u128 lhs, u128 rhs )
+{
+	return lhs.low == rhs.low && lhs.high == rhs.high;
+}
+
+[[nodiscard]] constexpr inline bool operator!=( u128 lhs, u128 rhs )
+{
+	return !( lhs == rhs );
+}
+
+[[nodiscard]] constexpr inline bool operator<( u128 lhs, u128 rhs )
+{
+	return lhs.high < rhs.high || ( lhs.high == rhs.high && lhs.low < rhs.low );
+}
+
+[[nodiscard]] constexpr inline bool operator>( u128 lhs, u128 rhs )
+{
+	return rhs < lhs;
+}
+
+[[nodiscard]] constexpr inline bool operator<=( u128 lhs, u128 rhs )
+{
+	return !( rhs < lhs );
+}
+
+[[nodiscard]] constexpr inline bool operator>=( u128 lhs, u128 rhs )
+{
+	return !( lhs < rhs );
+}
+
+[[nodiscard]] constexpr inline u128 operator+( u128 lhs, u128 rhs )
+{
+	u64 low = lhs.low + rhs.low;
+	return u128( lhs.high + rhs.high + ( low < lhs.low ), low );
+}
+
+[[nodiscard]] constexpr inline u128 operator-( u128 lhs, u128 rhs )
+{
+	return u128( lhs.high - rhs.high - ( lhs.low < rhs.low ), lhs.low - rhs.low );
+}
+
+[[nodiscard]] constexpr inline u128 operator&( u128 lhs, u128 rhs )
+{
+	return u128( lhs.high & rhs.high, lhs.low & rhs.low );
+}
+
+[[nodiscard]] constexpr inline u128 operator|( u128 lhs, u128 rhs )
+{
+	return u128( lhs.high | rhs.high, lhs.low | rhs.low );
+}
+
+[[nodiscard]] constexpr inline u128 operator<<( u128 value, u32 shift )
+{
+	if ( shift == 0 )
+		return value;
+
+	if ( shift >= 64 )
+		return u128( value.low << ( shift - 64 ), 0 );
+
+	return u128( ( value.high << shift ) | ( value.low >> ( 64 - shift ) ), value.low << shift );
+}
+
+[[nodiscard]] constexpr inline u128 operator>>( u128 value, u32 shift )
+{
+	if ( shift == 0 )
+		return value;
+
+	if ( shift >= 64 )
+		return u128( 0, value.high >> ( shift - 64 ) );
+
+	return u128( value.high >> shift, ( value.low >> shift ) | ( value.high << ( 64 - shift ) ) );
+}
+
+/// @desc a where mask is all ones and b where it is zero, without a branch for the predictor to miss
+[[nodiscard]] constexpr inline u128 mask_select( u64 mask, u128 a, u128 b )
+{
+	return u128( ( a.high & mask ) | ( b.high & ~mask ), ( a.low & mask ) | ( b.low & ~mask ) );
+}
+
+/// @desc The low 128 bits of the product
+[[nodiscard]] inline u128 operator*( u128 lhs, u128 rhs )
+{
+	u64 high;
+	u64 low = multiply_128( lhs.low, rhs.low, &high );
+
+	return u128( high + lhs.low * rhs.high + lhs.high * rhs.low, low );
+}
+
+/// @desc Full 256 bit product of a and b
+/// @return The low 128 bits, the high 128 bits are written to high
+[[nodiscard]] inline u128 multiply_256( u128 a, u128 b, u128 *high )
+{
+	u64 p0High, p1High, p2High, p3High;
+	u64 p0 = multiply_128( a.low, b.low, &p0High );
+	u64 p1 = multiply_128( a.low, b.high, &p1High );
+	u64 p2 = multiply_128( a.high, b.low, &p2High );
+	u64 p3 = multiply_128( a.high, b.high, &p3High );
+
+	// Words 1 to 3 are sums of the halves of the products, a carry chain each for the two middle products
+	u8 carry = 0;
+	u64 word1 = add_with_carry( p0High, p1, &carry );
+	u64 word2 = add_with_carry( p1High, p3, &carry );
+	u64 word3 = add_with_carry( p3High, 0, &carry );
+
+	carry = 0;
+	word1 = add_with_carry( word1, p2, &carry );
+	word2 = add_with_carry( word2, p2High, &carry );
+	word3 = add_with_carry( word3, 0, &carry );
+
+	*high = u128( word3, word2 );
+
+	return u128( word1, p0 );
+}
+
+/// @desc numerator / divisor, the remainder is written to remainder when given
+[[nodiscard]] inline u128 divide( u128 numerator, u128 divisor, u128 *remainder = nullptr )
+{
+	massert( divisor != 0 );
+
+	u128 quotient = 0;
+
+	if ( numerator < divisor )
+	{
+		// Nothing to divide
+	}
+	else if ( divisor.high == 0 )
+	{
+		// Two 128 by 64 bit divisions, the first remainder is below the divisor so the second quotient fits
+		u64 rest;
+		quotient.high = numerator.high / divisor.low;
+		quotient.low = divide_128( numerator.high % divisor.low, numerator.low, divisor.low, &rest );
+		numerator = rest;
+	}
+	else
+	{
+		// The quotient fits a u64, shift and subtract one bit of it at a time
+		u32 shift = count_leading_zeros( divisor.high ) - count_leading_zeros( numerator.high );
+		divisor = divisor << shift;
+
+		for ( u32 i = 0; i <= shift; ++i )
+		{
+			// Each bit is as likely to be set as not, the subtraction is kept by mask rather than a branch
+			u8 borrow = 0;
+			u64 low = subtract_with_borrow( numerator.low, divisor.low, &borrow );
+			u64 high = subtract_with_borrow( numerator.high, divisor.high, &borrow );
+			u64 fits = static_cast<u64>( borrow ) - 1;
+
+			numerator = mask_select( fits, u128( high, low ), numerator );
+			quotient.low = ( quotient.low << 1 ) | ( fits & 1 );
+			divisor = divisor >> 1;
+		}
+	}
+
+	if ( remainder )
+		*remainder = numerator;
+
+	return quotient;
+}
+
+[[nodiscard]] inline u128 operator/( u128 lhs, u128 rhs )
+{
+	return divide( lhs, rhs );
+}
+
+[[nodiscard]] inline u128 operator%( u128 lhs, u128 rhs )
+{
+	u128 remainder;
+	(void)divide( lhs, rhs, &remainder );
+	return remainder;
+}
+
+inline u128 &operator+=( u128 &lhs, u128 rhs ) { return lhs = lhs + rhs; }
+inline u128 &operator-=( u128 &lhs, u128 rhs ) { return lhs = lhs - rhs; }
+inline u128 &operator*=( u128 &lhs, u128 rhs ) { return lhs = lhs * rhs; }
+inline u128 &operator/=( u128 &lhs, u128 rhs ) { return lhs = lhs / rhs; }
+inline u128 &operator%=( u128 &lhs, u128 rhs ) { return lhs = lhs % rhs; }
+inline u128 &operator<<=( u128 &lhs, u32 shift ) { return lhs = lhs << shift; }
+inline u128 &operator>>=( u128 &lhs, u32 shift ) { return lhs = lhs >> shift; }
+
+[[nodiscard]] inline u32 count_trailing_zeros( u128 value )
+{
+	return value.low ? count_trailing_zeros( value.low ) : 64 + count_trailing_zeros( value.high );
+}
+
+[[nodiscard]] inline u32 count_leading_zeros( u128 value )
+{
+	return value.high ? count_leading_zeros( value.high ) : 64 + count_leading_zeros( value.low );
+}
+
+[[nodiscard]] inline u128 greatest_common_divisor( u128 a, u128 b )
+{
+	if ( a == 0 )
+		return b;
+
+	if ( b == 0 )
+		return a;
+
+	// Binary gcd, the shared powers of 2 are put back at the end
+	u32 shift = count_trailing_zeros( a | b );
+	a >>= count_trailing_zeros( a );
+
+	while ( b != 0 )
+	{
+		b >>= count_trailing_zeros( b );
+
+		if ( a > b )
+		{
+			u128 swap = a;
+			a = b;
+			b = swap;
+		}
+
+		b -= a;
+	}
+
+	return a << shift;
+}
+
+[[nodiscard]] inline u64 integer_sqrt( u128 value )
+{
+	if ( value.high == 0 )
+		return integer_sqrt( value.low );
+
+	// The 53 bit mantissa gets about 52 bits of the 64 bit root right, one Newton step leaves it off by a few at most
+	// and the loops below finish it
+	f64 estimate = sqrt( static_cast<f64>( value.high ) * 18446744073709551616.0 + static_cast<f64>( value.low ) );
+	u64 root = ( estimate >= 18446744073709551615.0 ) ? UINT64_MAX : static_cast<u64>( estimate );
+	u128 step = ( u128( root ) + value / root ) >> 1;
+	root = ( step.high ) ? UINT64_MAX : step.low;
+
+	u64 squareHigh;
+	u64 squareLow = multiply_128( root, root, &squareHigh );
+
+	while ( u128( squareHigh, squareLow ) > value )
+	{
+		--root;
+		squareLow = multiply_128( root, root, &squareHigh );
+	}
+
+	while ( root < UINT64_MAX )
+	{
+		squareLow = multiply_128( root + 1, root + 1, &squareHigh );
+
+		if ( u128( squareHigh, squareLow ) > value )
+			break;
+
+		++root;
+	}
+
+	return root;
+}
+
+/// @desc Reads a decimal u128, leading spaces are skipped
+/// @return The value, 0 with a warning when it is not a number or does not fit
+[[nodiscard]] u128 convert_to_u128( const char *input, const char **output = nullptr );
+
+u64 convert_to_string( char *dest, u64 destSize, u128 value, i32 radix = 10, i32 trailing = 0 );
+[[nodiscard]] const char *convert_to_string( u128 value, i32 radix = 10, i32 trailing = 0 );
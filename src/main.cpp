@@ -4,6 +4,14 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#ifdef _MSC_VER
+#	include <intrin.h>
+#elif defined( __x86_64__ )
+#	include <immintrin.h>
+#endif
 
 // Includes
 #include "defines.h"
@@ -12,21 +20,65 @@
 #include "array.h"
 #include "strings.h"
 #include "map.h"
-#include "utility.h"
 #include "platform.h"
+#include "utility.h"
+#include "integer_128.h"
+#include "checksum.h"
+#include "prime_tables.h"
+#include "primality.h"
+#include "factorise.h"
+#include "ecm.h"
+#include "siqs.h"
+#include "prime_stats.h"
+#include "prime_tuple.h"
+#include "sieve.h"
+#include "sieve_wheel.h"
+#include "sieve_tune.h"
+#include "prime_file.h"
+#include "prime_shard.h"
+#include "prime_count.h"
 #include "result_code.h"
 
 using ProgramFlags = u32;
 enum PROGRAM_FLAGS : ProgramFlags
 {
 	PROGRAM_FLAG_VERBOSE = BIT( 0 ),
+	PROGRAM_FLAG_STATISTICS = BIT( 1 ),		// tally the statistics of generated primes into PRIME_STATS_FILE
 };
 constexpr const ProgramFlags DEFAULT_PROGRAM_FLAGS = 0;
 
+// What to do once initialised, anything other than the menu runs once and exits
+using ProgramTask = u32;
+enum PROGRAM_TASK : ProgramTask
+{
+	PROGRAM_TASK_MENU,
+	PROGRAM_TASK_RANGE,
+	PROGRAM_TASK_EXTEND,
+	PROGRAM_TASK_COUNT,
+	PROGRAM_TASK_BITMAP,
+	PROGRAM_TASK_TUPLES,
+	PROGRAM_TASK_PRIME_BENCHMARK,
+	PROGRAM_TASK_VERIFY,
+	PROGRAM_TASK_MANIFEST,
+	PROGRAM_TASK_SHARD,
+	PROGRAM_TASK_SHARDS,
+	PROGRAM_TASK_MERGE,
+};
+
 struct Program
 {
 	ProgramFlags flags;
+	ProgramTask task;
+	u64 taskArguments[ 2 ];
+	const char *taskPath;
+	RESULT_CODE result;						// exit code, set when a task fails
 	MemoryArena memoryArena;
+	SieveEngine sieveEngine;
+	PrimeFileFormat primeFileFormat;
+	u64 sieveSegmentBytes;					// -segment override, 0 to use the tuning
+	SieveTuning sieveTuning;
+	u32 threadCount;
+	u64 writerBlockBytes;
 	char workingDirectory[ MAX_WORKING_DIRECTORY_PATH ];
 	char consoleInput[ MAX_CONSOLE_INPUT ];
 };
@@ -41,7 +93,21 @@ Program *program;
 #endif
 
 // Implements
+#include "platform_writer.cpp"
 #include "utility.cpp"
+#include "checksum.cpp"
+#include "primality.cpp"
+#include "factorise.cpp"
+#include "ecm.cpp"
+#include "siqs.cpp"
+#include "prime_stats.cpp"
+#include "sieve.cpp"
+#include "sieve_wheel.cpp"
+#include "sieve_tune.cpp"
+#include "prime_tuple.cpp"
+#include "prime_file.cpp"
+#include "prime_shard.cpp"
+#include "prime_count.cpp"
 
 // -------------------------------------------------------------------------
 
@@ -61,8 +127,33 @@ void timer_stop()
 
 const char *get_input()
 {
-	fgets( program->consoleInput, sizeof( program->consoleInput ), stdin );
-	return program->consoleInput;
+	char *input = program->consoleInput;
+
+	if ( !fgets( input, sizeof( program->consoleInput ), stdin ) )
+		input[ 0 ] = '\0';
+
+	// Without the line ending, so a name compares equal and an empty line is empty
+	u64 length = strlen( input );
+
+	while ( length > 0 && ( input[ length - 1 ] == '\n' || input[ length - 1 ] == '\r' ) )
+		input[ --length ] = '\0';
+
+	return input;
+}
+
+/// @desc Reads a number argument of an option, warns and returns false unless all of it is a number that fits a u64
+static bool option_u64( const char *argument, u64 *value )
+{
+	const char *end;
+	*value = convert_to_u64( argument, &end );
+
+	if ( end == argument || *end != '\0' )
+	{
+		show_log_warning( "Invalid number: %s", argument );
+		return false;
+	}
+
+	return true;
 }
 
 // -------------------------------------------------------------------------
@@ -78,6 +169,24 @@ static RESULT_CODE usage_message( RESULT_CODE code )
 	show_log_message( "[-ra]                        EG. -ra                              (outputs received arguments)" );
 	show_log_message( "[-wd] <path>                 EG. -wd TEMP\\                        (override the default working directory)" );
 	show_log_message( "[-memory] <bytes> <bytes>    EG. -memory 1024 2048                (specify memory allocation - perma, transient)" );
+	show_log_message( "[-range] <low> <high>        EG. -range 1000000000 1000001000     (write the primes in [low, high] to %s and exit)", PRIME_RANGE_FILE );
+	show_log_message( "[-extend] <highest>          EG. -extend 2000000000               (append the primes up to highest to %s and exit)", PRIME_NUMBER_FILE );
+	show_log_message( "[-count] <highest>           EG. -count 1000000000000             (count the primes up to highest without generating them and exit)" );
+	show_log_message( "[-bitmap] <highest>          EG. -bitmap 1000000000               (write a bitmap of the primes up to highest to %s and exit)", PRIME_BITMAP_FILE );
+	show_log_message( "[-tuples] <kind> <highest>   EG. -tuples twins 100000000000       (write the first prime of each twins, cousins, sexy, triplets or sophie_germain tuple up to highest to %s and exit)", PRIME_TUPLE_FILE );
+	show_log_message( "[-primebench] <count>        EG. -primebench 10000000             (time is_prime against is_prime_batch on count random candidates and exit)" );
+	show_log_message( "[-verify] <path>             EG. -verify prime_numbers.bin        (check a prime file against its checksums and exit)" );
+	show_log_message( "[-manifest] <shards> <highest> EG. -manifest 16 100000000000      (plan shards of the primes up to highest in %s and exit)", PRIME_MANIFEST_FILE );
+	show_log_message( "[-shard] <index>             EG. -shard 3                         (generate shard index of %s and exit)", PRIME_MANIFEST_FILE );
+	show_log_message( "[-shards] <shards> <highest> EG. -shards 8 10000000000            (plan the shards, generate them in local processes and merge them, then exit, Windows only)" );
+	show_log_message( "[-merge]                     EG. -merge                           (check the shards of %s and merge them into %s, then exit)", PRIME_MANIFEST_FILE, PRIME_NUMBER_FILE );
+	show_log_message( "[-segment] <bytes>           EG. -segment 32768                   (sieve segment size, overrides the tuning for benchmarking)" );
+	show_log_message( "[-calibrate]                 EG. -calibrate                       (time the segment sizes that suit the caches and keep the fastest in %s)", SIEVE_TUNING_FILE );
+	show_log_message( "[-engine] <odd|wheel>        EG. -engine odd                      (sieve engine used for generation, defaults to wheel)" );
+	show_log_message( "[-format] <raw|gap>          EG. -format gap                      (format of a newly generated %s, defaults to raw)", PRIME_NUMBER_FILE );
+	show_log_message( "[-stats]                     EG. -stats                           (tally gaps, twins and residue classes while generating into %s)", PRIME_STATS_FILE );
+	show_log_message( "[-threads] <count>           EG. -threads 8                       (worker threads used for generation, defaults to the core count)" );
+	show_log_message( "[-writeblock] <bytes>        EG. -writeblock 4194304              (bytes buffered per write to the prime files, defaults to 1MB)" );
 
 	return code;
 }
@@ -93,8 +202,18 @@ RESULT_CODE initialise( int argc, const char *argv[] )
 	{
 		u64 permanentSize = MB( 2 );
 		u64 transientSize = MB( 2 );
+		SieveEngine engine = SIEVE_ENGINE_WHEEL;
+		PrimeFileFormat fileFormat = PRIME_FILE_FORMAT_RAW;
+		u64 segmentBytes = 0;
+		bool calibrate = false;
+		u32 threadCount = std::thread::hardware_concurrency();
+		u64 writerBlockBytes = DEFAULT_FILE_WRITER_BLOCK;
 		const char *workingDirectory = nullptr;
 		bool verbose = false;
+		bool statistics = false;
+		ProgramTask task = PROGRAM_TASK_MENU;
+		u64 taskArguments[ 2 ] = {};
+		const char *taskPath = nullptr;
 	};
 
 	Options options;
@@ -128,8 +247,314 @@ RESULT_CODE initialise( int argc, const char *argv[] )
 
 		commands.insert( "-memory", [] ( Options &options, int &index, int argc, const char *argv[] )
 			{
-				options.permanentSize = convert_to_u64( argv[ ++index ] );
-				options.transientSize = convert_to_u64( argv[ ++index ] );
+				if ( index + 2 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( !option_u64( argv[ ++index ], &options.permanentSize ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				if ( !option_u64( argv[ ++index ], &options.transientSize ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-range", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 2 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_RANGE;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 1 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.taskArguments[ 0 ] > options.taskArguments[ 1 ] )
+				{
+					show_log_warning( "Invalid range: %s > %s", argv[ index - 1 ], argv[ index ] );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-extend", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_EXTEND;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-count", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_COUNT;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.taskArguments[ 0 ] > PRIME_COUNT_MAX )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-bitmap", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_BITMAP;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-tuples", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 2 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_TUPLES;
+				options.taskArguments[ 0 ] = prime_tuple_from_name( argv[ ++index ] );
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 1 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.taskArguments[ 0 ] == PRIME_TUPLE_COUNT )
+				{
+					show_log_warning( "Unknown tuple: %s (twins, cousins, sexy, triplets, sophie_germain)", argv[ index - 1 ] );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				if ( options.taskArguments[ 1 ] > PRIME_TUPLE_MAX )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-primebench", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_PRIME_BENCHMARK;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.taskArguments[ 0 ] == 0 )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-verify", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_VERIFY;
+				options.taskPath = argv[ ++index ];
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-manifest", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 2 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_MANIFEST;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 1 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.taskArguments[ 0 ] == 0 || options.taskArguments[ 0 ] > PRIME_SHARD_MAX )
+				{
+					show_log_warning( "Invalid shard count: %s (1 - %u)", argv[ index - 1 ], PRIME_SHARD_MAX );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-shard", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_SHARD;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-shards", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 2 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				options.task = PROGRAM_TASK_SHARDS;
+
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 0 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				if ( !option_u64( argv[ ++index ], &options.taskArguments[ 1 ] ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.taskArguments[ 0 ] == 0 || options.taskArguments[ 0 ] > PRIME_SHARD_MAX )
+				{
+					show_log_warning( "Invalid shard count: %s (1 - %u)", argv[ index - 1 ], PRIME_SHARD_MAX );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-merge", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				options.task = PROGRAM_TASK_MERGE;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-segment", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( !option_u64( argv[ ++index ], &options.segmentBytes ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.segmentBytes == 0 )
+				{
+					show_log_warning( "Invalid segment size: %s", argv[ index ] );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-calibrate", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				options.calibrate = true;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-stats", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				options.statistics = true;
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-writeblock", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( !option_u64( argv[ ++index ], &options.writerBlockBytes ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( options.writerBlockBytes == 0 || options.writerBlockBytes > MAX_FILE_WRITER_BLOCK )
+				{
+					show_log_warning( "Invalid write block size: %s", argv[ index ] );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-engine", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				const char *engine = argv[ ++index ];
+
+				if ( string_utf8_compare( engine, "odd" ) )
+				{
+					options.engine = SIEVE_ENGINE_ODD;
+				}
+				else if ( string_utf8_compare( engine, "wheel" ) )
+				{
+					options.engine = SIEVE_ENGINE_WHEEL;
+				}
+				else
+				{
+					show_log_warning( "Unknown sieve engine: %s", engine );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-format", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				const char *format = argv[ ++index ];
+
+				if ( string_utf8_compare( format, "raw" ) )
+				{
+					options.fileFormat = PRIME_FILE_FORMAT_RAW;
+				}
+				else if ( string_utf8_compare( format, "gap" ) )
+				{
+					options.fileFormat = PRIME_FILE_FORMAT_GAP;
+				}
+				else
+				{
+					show_log_warning( "Unknown prime file format: %s", format );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				return RESULT_CODE_SUCCESS;
+			} );
+
+		commands.insert( "-threads", [] ( Options &options, int &index, int argc, const char *argv[] )
+			{
+				if ( index + 1 >= argc )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				u64 threadCount;
+
+				if ( !option_u64( argv[ ++index ], &threadCount ) )
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+
+				if ( threadCount == 0 || threadCount > UINT32_MAX )
+				{
+					show_log_warning( "Invalid thread count: %s", argv[ index ] );
+					return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+				}
+
+				// Past a few per core more threads only cost memory, and enough of them fail to start at all
+				u64 cores = std::thread::hardware_concurrency();
+				u64 maxThreads = MAX_THREADS_PER_CORE * ( cores ? cores : 1 );
+
+				if ( threadCount > maxThreads )
+				{
+					show_log_warning( "%llu threads is more than %llu per core, using %llu.", threadCount, MAX_THREADS_PER_CORE, maxThreads );
+					threadCount = maxThreads;
+				}
+
+				options.threadCount = static_cast<u32>( threadCount );
 
 				return RESULT_CODE_SUCCESS;
 			} );
@@ -151,6 +576,19 @@ RESULT_CODE initialise( int argc, const char *argv[] )
 				return RESULT_CODE_UNKNOWN_OPTIONAL_COMMAND;
 			}
 		}
+
+		// -segment is checked once -engine can no longer change, the bitmap and the tuples always use the wheel and
+		// Sophie Germain tuples sieve 2p + 1 with segments twice as large
+		bool wheel = ( options.engine == SIEVE_ENGINE_WHEEL || options.task == PROGRAM_TASK_BITMAP || options.task == PROGRAM_TASK_TUPLES );
+		bool doubled = ( options.task == PROGRAM_TASK_TUPLES && options.taskArguments[ 0 ] == PRIME_TUPLE_SOPHIE_GERMAIN );
+		u64 minSegmentBytes = sieve_min_segment_bytes( wheel ? SIEVE_ENGINE_WHEEL : SIEVE_ENGINE_ODD );
+		u64 maxSegmentBytes = sieve_max_segment_bytes( wheel ? SIEVE_ENGINE_WHEEL : SIEVE_ENGINE_ODD, doubled );
+
+		if ( options.segmentBytes && ( options.segmentBytes < minSegmentBytes || options.segmentBytes > maxSegmentBytes ) )
+		{
+			show_log_warning( "Invalid segment size: %llu (%llu - %llu for the %s sieve)", options.segmentBytes, minSegmentBytes, maxSegmentBytes, wheel ? "wheel" : "odd" );
+			return RESULT_CODE_INVALID_OPTIONAL_ARGUMENT;
+		}
 	}
 
 	// Memory
@@ -168,6 +606,18 @@ RESULT_CODE initialise( int argc, const char *argv[] )
 	program->flags = DEFAULT_PROGRAM_FLAGS;
 	if ( options.verbose )
 		program->flags |= PROGRAM_FLAG_VERBOSE;
+	if ( options.statistics )
+		program->flags |= PROGRAM_FLAG_STATISTICS;
+
+	program->task = options.task;
+	program->taskArguments[ 0 ] = options.taskArguments[ 0 ];
+	program->taskArguments[ 1 ] = options.taskArguments[ 1 ];
+	program->taskPath = options.taskPath;
+	program->sieveEngine = options.engine;
+	program->primeFileFormat = options.fileFormat;
+	program->sieveSegmentBytes = options.segmentBytes;
+	program->threadCount = options.threadCount ? options.threadCount : 1;
+	program->writerBlockBytes = options.writerBlockBytes;
 
 	// Give the memory to the program
 	program->memoryArena = memory;
@@ -186,11 +636,41 @@ RESULT_CODE initialise( int argc, const char *argv[] )
 	// Working Directory
 	platform_set_current_directory( options.workingDirectory ? options.workingDirectory : platform_get_current_directory( &program->memoryArena ) );
 
+	// Sieve segment sizes, kept in the working directory once worked out for this processor
+	if ( !options.segmentBytes || options.calibrate )
+	{
+		CacheSizes caches;
+
+		if ( !platform_get_cache_sizes( &caches ) )
+			show_log_warning( "Unable to read the cache sizes, assuming %llu bytes of L1.", DEFAULT_SIEVE_SEGMENT_BYTES );
+
+		SieveTuning *tuning = &program->sieveTuning;
+
+		if ( options.calibrate || !sieve_tuning_load( tuning, &caches, SIEVE_TUNING_FILE ) )
+		{
+			sieve_tuning_from_caches( tuning, &caches );
+
+			if ( options.calibrate )
+			{
+				show_log_info( "Calibrating the sieve segment sizes..." );
+				sieve_tuning_calibrate( tuning );
+			}
+
+			if ( !sieve_tuning_save( tuning, SIEVE_TUNING_FILE ) )
+				show_log_warning( "Failed to write file: %s", SIEVE_TUNING_FILE );
+		}
+
+		verbose_log_message( "Sieve segments: %llu bytes odd, %llu bytes wheel with bucket pages of %u entries (%s, L1 %llu, L2 %llu).", tuning->oddSegmentBytes,
+			tuning->wheelSegmentBytes, wheel_bucket_page_entries( tuning->wheelSegmentBytes ), tuning->calibrated ? "calibrated" : "from the caches", caches.l1Data, caches.l2 );
+	}
+
 	return RESULT_CODE_SUCCESS;
 }
 
 int shutdown()
 {
+	RESULT_CODE result = program->result;
+
 	platform_cleanup();
 
 	// Unbind the memory from program before freeing (since it contains the program itself)
@@ -200,152 +680,772 @@ int shutdown()
 
 	platform_logger_close();
 
-	return RESULT_CODE_SUCCESS;
+	return result;
+}
+
+/// @desc Segment size for the engine, -segment when given otherwise the tuning
+[[nodiscard]] static u64 sieve_segment_bytes( SieveEngine engine )
+{
+	return program->sieveSegmentBytes ? program->sieveSegmentBytes : sieve_tuning_segment_bytes( &program->sieveTuning, engine );
+}
+
+/// @desc The exclusive end of a sieve range that takes in highest. 2^64 - 1 itself is not prime so clamping loses nothing
+[[nodiscard]] static u64 sieve_end_inclusive( u64 highest )
+{
+	return highest < UINT64_MAX ? highest + 1 : UINT64_MAX;
 }
 
-u64 generate_prime_numbers( u64 to )
+template <typename SieveType, typename Output>
+static bool generate_prime_numbers_with( u64 from, u64 to, u64 *found, Output output, PrimeStats *stats )
 {
 	u64 primeNumbersFound = 0;
 
-	u32 file = platform_open_file( PRIME_NUMBER_FILE, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
-	if ( file == INVALID_FILE_INDEX )
+	if ( stats )
+		prime_stats_begin( stats, from );
+
+	if ( program->threadCount > 1 )
 	{
-		show_log_warning( "Failed to create or open file: %s", PRIME_NUMBER_FILE );
-		return 0;
+		// Chunks arrive in ascending order, so the output matches the single threaded one
+		if ( !sieve_parallel<SieveType>( from, to, sieve_segment_bytes( SieveType::ENGINE ), program->threadCount, &primeNumbersFound, [&] ( const SieveChunk &chunk )
+			{
+				output( chunk.primes.data(), chunk.primes.size() );
+			}, stats ) )
+		{
+			return false;
+		}
 	}
+	else
+	{
+		SieveType sieve;
 
-	// Write a blank entry at the start for the total number of primes found
-	u64 value = 0;
-	platform_write_to_file( file, &value, sizeof( u64 ) );
-
-	value = 2;
-	platform_write_to_file( file, &value, sizeof( u64 ) );
-	++primeNumbersFound;
+		if ( !sieve_initialise( &sieve, from, to, sieve_segment_bytes( SieveType::ENGINE ) ) )
+			return false;
 
-	{
-		timer_start();
+		std::vector<u64> primes( sieve_segment_capacity( &sieve ) );
 
-		for ( u64 i = 3; i < to; i += 2 )
+		while ( !sieve_finished( &sieve ) )
 		{
-			if ( is_prime( i ) )
-			{
-				platform_write_to_file( file, &i, sizeof( u64 ) );
-				++primeNumbersFound;
-			}
-		}
+			u64 count = sieve_next_segment( &sieve, primes.data() );
 
-		timer_stop();
-	}
+			output( primes.data(), count );
+			primeNumbersFound += count;
 
-	show_message( "\n%llu Prime Numbers found (0 - %llu).", primeNumbersFound, to );
+			if ( stats )
+				prime_stats_add( stats, primes.data(), count );
+		}
 
-	// Write the number at the start
-	platform_seek_in_file( file, FILE_SEEK_START, 0 );
-	platform_write_to_file( file, &primeNumbersFound, sizeof( u64 ) );
+		if ( stats )
+			prime_stats_end( stats, to );
+	}
 
-	platform_close_file( file );
+	*found = primeNumbersFound;
 
-	return primeNumbersFound;
+	return true;
 }
 
-const char *get_positional_ending( u64 value )
+/// @desc Sieves [from, to) with the selected engine, output( const u64 *primes, u64 count ) receives them in ascending order
+/// and the number found is written to found. Pass stats to tally the primes of [from, to) into them on the way.
+/// @return false when the engine could not sieve with the segment size, nothing was output
+template <typename Output>
+static bool generate_prime_numbers_engine( u64 from, u64 to, u64 *found, Output output, PrimeStats *stats = nullptr )
 {
-	switch ( value % 10 )
+	*found = 0;
+
+	switch ( program->sieveEngine )
 	{
-	case 1: return "st";
-	case 2: return "nd";
-	case 3: return "rd";
+	case SIEVE_ENGINE_ODD:		return generate_prime_numbers_with<Sieve>( from, to, found, output, stats );
+	case SIEVE_ENGINE_WHEEL:	return generate_prime_numbers_with<WheelSieve>( from, to, found, output, stats );
 	}
 
-	return "th";
+	return false;
 }
 
-// -------------------------------------------------------------------------
-void single_prime_finding( u64 &rem, std::vector<u64> &primeFactor, const std::vector<u64> &primesUsed )
+bool generate_prime_numbers( u64 to )
 {
-	u64 primeFactorValue = primesUsed[ 0 ];
+	u64 primeNumbersFound = 0;
 
-	do
+	u32 file = platform_open_file( PRIME_NUMBER_FILE, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( file == INVALID_FILE_INDEX )
 	{
-		primeFactor.push_back( primeFactorValue );
-		rem = rem / primeFactorValue;
-
-	} while ( rem != 1 );
-}
+		show_log_warning( "Failed to create or open file: %s", PRIME_NUMBER_FILE );
+		return false;
+	}
 
-void multi_prime_finding( u64 &rem, std::vector<u64> &primeFactor, const std::vector<u64> &possiblePrimesUsed )
-{
-	if ( rem == 1 )
-		return;
+	// The header is advanced at each checkpoint
+	PrimeFileAppend append;
+	prime_file_append_begin( &append, file, program->primeFileFormat, 2, to, program->writerBlockBytes );
 
-	std::vector<u64> primesUsed;
+	// Tallied alongside the sieve rather than read back from the file afterwards
+	bool statistics = ( program->flags & PROGRAM_FLAG_STATISTICS ) != 0;
+	std::vector<PrimeStats> stats( statistics ? 1 : 0 );
 
-	u64 pos = 0;
+	bool sieved;
 
-	while ( pos < possiblePrimesUsed.size() && possiblePrimesUsed[ pos ] <= rem )
 	{
-		if ( rem % possiblePrimesUsed[ pos ] == 0 )
-			primesUsed.push_back( possiblePrimesUsed[ pos ] );
+		timer_start();
 
-		++pos;
-	}
+		sieved = generate_prime_numbers_engine( 2, to, &primeNumbersFound, [&] ( const u64 *primes, u64 count )
+			{
+				prime_file_append( &append, primes, count );
+			}, statistics ? stats.data() : nullptr );
 
-	if ( primesUsed.size() == 1 )
-	{
-		single_prime_finding( rem, primeFactor, primesUsed );
+		timer_stop();
 	}
-	else
+
+	// The file must not claim primes that were never sieved
+	if ( !sieved )
 	{
-		for ( u64 i = 0; i < primesUsed.size(); ++i)
-		{
-			rem = rem / primesUsed[ i ];
-			primeFactor.push_back( primesUsed[ i ] );
-		}
+		prime_file_append_cancel( &append );
+		platform_close_file( file );
+		return false;
 	}
 
-	multi_prime_finding( rem, primeFactor, primesUsed );
+	show_message( "\n%llu Prime Numbers found (0 - %llu).", primeNumbersFound, to );
+
+	bool written = prime_file_append_end( &append, to );
+
+	if ( !written )
+		show_log_warning( "Failed to write file: %s", PRIME_NUMBER_FILE );
+
+	if ( statistics && prime_stats_write( stats.data(), PRIME_STATS_FILE ) )
+		show_message( "Statistics written to %s.", PRIME_STATS_FILE );
+
+	platform_close_file( file );
+
+	return written;
 }
 
-void prime_factorisation()
+bool extend_prime_numbers( u64 highest )
 {
+	u32 file = platform_open_file( PRIME_NUMBER_FILE, FILE_OPTION_READ | FILE_OPTION_WRITE );
+	if ( file == INVALID_FILE_INDEX )
+	{
+		show_log_warning( "Generate some prime numbers first." );
+		return false;
+	}
+
+	PrimeFileReader reader;
+
+	if ( !prime_file_read_begin( &reader, file ) )
+	{
+		show_log_warning( "Prime number file corrupted. Regenerate." );
+		platform_close_file( file );
+		return false;
+	}
+
+	// Every prime below the limit of the header is in the file, whether or not the last one was near it
+	u64 from = reader.header.limit;
+
+	// An interrupted run left the file without its trailer, it is still resumed and ended to write one
+	bool reached = ( highest < from );
+
+	if ( reached && reader.header.trailerOffset )
+	{
+		show_message( "\nThe prime number file already reaches %llu.", from - 1 );
+		platform_close_file( file );
+		return true;
+	}
+
+	u64 to = reached ? from : sieve_end_inclusive( highest );
+
+	// New primes keep to the format of the file
+	PrimeFileAppend append;
+
+	if ( !prime_file_append_resume( &append, &reader, to, program->writerBlockBytes ) )
+	{
+		show_log_warning( "Failed to resize file: %s", PRIME_NUMBER_FILE );
+		platform_close_file( file );
+		return false;
+	}
+
+	u64 primeNumbersFound = 0;
+	bool sieved;
+
+	{
+		timer_start();
+
+		sieved = generate_prime_numbers_engine( from, to, &primeNumbersFound, [&] ( const u64 *primes, u64 count )
+			{
+				prime_file_append( &append, primes, count );
+			} );
+
+		timer_stop();
+	}
+
+	// Left as it was, the next extend carries on from the same place
+	if ( !sieved )
+	{
+		prime_file_append_cancel( &append );
+		platform_close_file( file );
+		return false;
+	}
+
+	bool written = prime_file_append_end( &append, to );
+
+	if ( !written )
+		show_log_warning( "Failed to write file: %s", PRIME_NUMBER_FILE );
+
+	if ( reached )
+		show_message( "\nThe prime number file already reaches %llu, finished it with its checksums.", from - 1 );
+	else
+		show_message( "\n%llu Prime Numbers added (%llu - %llu), %llu in total.", primeNumbersFound, from, highest, append.header.count );
+
+	platform_close_file( file );
+
+	return written;
+}
+
+bool generate_prime_range( u64 low, u64 high )
+{
+	u64 primeNumbersFound = 0;
+
+	u32 file = platform_open_file( PRIME_RANGE_FILE, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( file == INVALID_FILE_INDEX )
+	{
+		show_log_warning( "Failed to create or open file: %s", PRIME_RANGE_FILE );
+		return false;
+	}
+
+	u64 to = sieve_end_inclusive( high );
+
+	PrimeFileAppend append;
+	prime_file_append_begin( &append, file, PRIME_FILE_FORMAT_RAW, low, to, program->writerBlockBytes );
+
+	bool sieved;
+
+	{
+		timer_start();
+
+		sieved = generate_prime_numbers_engine( low, to, &primeNumbersFound, [&] ( const u64 *primes, u64 count )
+			{
+				prime_file_append( &append, primes, count );
+			} );
+
+		timer_stop();
+	}
+
+	if ( !sieved )
+	{
+		prime_file_append_cancel( &append );
+		platform_close_file( file );
+		return false;
+	}
+
+	show_message( "\n%llu Prime Numbers found (%llu - %llu).", primeNumbersFound, low, high );
+
+	bool written = prime_file_append_end( &append, to );
+
+	if ( !written )
+		show_log_warning( "Failed to write file: %s", PRIME_RANGE_FILE );
+
+	platform_close_file( file );
+
+	return written;
+}
+
+bool generate_prime_bitmap( u64 highest )
+{
+	u64 primeNumbersFound = 0;
+
+	u64 to = sieve_end_inclusive( highest );
+
+	u32 file = platform_open_file( PRIME_BITMAP_FILE, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( file == INVALID_FILE_INDEX )
+	{
+		show_log_warning( "Failed to create or open file: %s", PRIME_BITMAP_FILE );
+		return false;
+	}
+
+	PrimeFileAppend append;
+	prime_file_append_begin( &append, file, PRIME_FILE_FORMAT_BITMAP, 0, to, program->writerBlockBytes );
+
+	bool sieved;
+
+	{
+		timer_start();
+
+		// 2, 3 and 5 are not on the wheel, they only count towards the total
+		for ( u64 p : { 2, 3, 5 } )
+			if ( p < to )
+				++primeNumbersFound;
+
+		prime_file_append_bits( &append, nullptr, 0, primeNumbersFound );
+
+		// The bytes of the wheel sieve are the file, no prime is ever collected
+		u64 wheelPrimes;
+		sieved = sieve_parallel_bitmap( 0, to, sieve_segment_bytes( SIEVE_ENGINE_WHEEL ), program->threadCount, &wheelPrimes, [&] ( const SieveChunk &chunk )
+			{
+				prime_file_append_bits( &append, chunk.bits.data(), chunk.bits.size(), chunk.count );
+			} );
+
+		primeNumbersFound += wheelPrimes;
+
+		timer_stop();
+	}
+
+	if ( !sieved )
+	{
+		prime_file_append_cancel( &append );
+		platform_close_file( file );
+		return false;
+	}
+
+	show_message( "\n%llu Prime Numbers found (0 - %llu).", primeNumbersFound, highest );
+
+	bool written = prime_file_append_end( &append, to );
+
+	if ( !written )
+		show_log_warning( "Failed to write file: %s", PRIME_BITMAP_FILE );
+
+	platform_close_file( file );
+
+	return written;
+}
+
+bool generate_prime_tuples( PrimeTuple tuple, u64 highest )
+{
+	u64 tuplesFound = 0;
+	u64 to = sieve_end_inclusive( highest );
+
+	char path[ 64 ];
+	string_utf8_format( path, PRIME_TUPLE_FILE, PRIME_TUPLE_NAMES[ tuple ] );
+
+	u32 file = platform_open_file( path, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( file == INVALID_FILE_INDEX )
+	{
+		show_log_warning( "Failed to create or open file: %s", path );
+		return false;
+	}
+
+	// The first primes of the tuples are ascending, so they go in a prime file like any other
+	PrimeFileAppend append;
+	prime_file_append_begin( &append, file, program->primeFileFormat, 2, to, program->writerBlockBytes );
+
+	bool sieved;
+
+	{
+		timer_start();
+
+		sieved = sieve_parallel_tuples( 0, to, tuple, sieve_segment_bytes( SIEVE_ENGINE_WHEEL ), program->threadCount, &tuplesFound, [&] ( const SieveChunk &chunk )
+			{
+				prime_file_append( &append, chunk.primes.data(), chunk.primes.size() );
+			} );
+
+		timer_stop();
+	}
+
+	if ( !sieved )
+	{
+		prime_file_append_cancel( &append );
+		platform_close_file( file );
+		return false;
+	}
+
+	show_message( "\n%llu %s found (0 - %llu).", tuplesFound, PRIME_TUPLE_NAMES[ tuple ], highest );
+
+	bool written = prime_file_append_end( &append, to );
+
+	if ( !written )
+		show_log_warning( "Failed to write file: %s", path );
+
+	platform_close_file( file );
+
+	return written;
+}
+
+void prime_lookup()
+{
+	PrimeBitmap bitmap;
+
+	if ( !prime_bitmap_load( &bitmap, PRIME_BITMAP_FILE ) )
+	{
+		show_log_warning( "Generate a prime bitmap first." );
+		return;
+	}
+
 	while ( true )
 	{
-		u64 minValue = 2;
-		u64 maxValue = 0;
+		show_message( "\nEnter 0 to exit." );
+		show_message_same_line( "Enter a number below %llu:", bitmap.limit );
+
+		const char *input = get_input();
+
+		if ( !input || input[ 0 ] == '0' || input[ 0 ] == '-' || input[ 0 ] == '\0' )
+			break;
+
+		u64 inputValue = convert_to_u64( input );
+
+		if ( inputValue == 0 || inputValue >= bitmap.limit )
+		{
+			show_log_warning( "Invalid input. The bitmap only covers the numbers below %llu.", bitmap.limit );
+			continue;
+		}
+
+		u64 previous = prime_bitmap_previous( &bitmap, inputValue );
+		u64 next = prime_bitmap_next( &bitmap, inputValue );
+
+		show_message( "\n> Input Value: %llu (%s)", inputValue, prime_bitmap_is_prime( &bitmap, inputValue ) ? "prime" : "not prime" );
+
+		if ( previous )
+			show_message( "> Previous Prime: %llu", previous );
+
+		if ( next )
+			show_message( "> Next Prime: %llu", next );
+		else
+			show_message( "> Next Prime: above %llu", bitmap.limit - 1 );
+	}
+
+	prime_bitmap_free( &bitmap );
+}
+
+bool count_prime_numbers( u64 highest )
+{
+	if ( highest > PRIME_COUNT_MAX )
+	{
+		show_log_warning( "An error has occured. The highest number must not be above %llu.", PRIME_COUNT_MAX );
+		return false;
+	}
+
+	u64 primeNumbersFound = 0;
+
+	{
+		timer_start();
+
+		primeNumbersFound = prime_count( highest, program->threadCount );
+
+		timer_stop();
+	}
+
+	show_message( "\n%llu Prime Numbers up to %llu.", primeNumbersFound, highest );
+
+	return true;
+}
+
+bool benchmark_primality( u64 count )
+{
+	struct CandidateSet
+	{
+		const char *name;
+		u64 mask;
+	};
+
+	static constexpr CandidateSet SETS[] = { { "Below 2^32", UINT32_MAX }, { "Full 64 bit", UINT64_MAX } };
+
+	SimdFeatures features = platform_get_simd_features();
+	show_message( "\nBatch lanes below 2^32: %s.", ( features & SIMD_FEATURE_AVX512 ) ? "AVX-512 (8)" : ( features & SIMD_FEATURE_AVX2 ) ? "AVX2 (4)" : "scalar (4)" );
 
+	std::vector<u64> candidates( count );
+	std::vector<u8> scalar( count );
+	std::vector<u8> batch( count );
+
+	// Odd values from a fixed xorshift sequence, every run times the same candidates
+	u64 state = 0x9E3779B97F4A7C15ull;
+	f64 frequency = static_cast<f64>( platform_get_tick_frequency() );
+	bool agreed = true;
+
+	for ( const CandidateSet &set : SETS )
+	{
+		for ( u64 &candidate : candidates )
 		{
-			u32 file = platform_open_file( PRIME_NUMBER_FILE, FILE_OPTION_READ );
-			if ( file == INVALID_FILE_INDEX )
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			candidate = ( state & set.mask ) | 1;
+		}
+
+		u64 start = platform_get_tick_counter();
+
+		for ( u64 i = 0; i < count; ++i )
+			scalar[ i ] = is_prime( candidates[ i ] );
+
+		u64 scalarTicks = platform_get_tick_counter() - start + 1;
+
+		start = platform_get_tick_counter();
+		is_prime_batch( candidates.data(), batch.data(), count );
+		u64 batchTicks = platform_get_tick_counter() - start + 1;
+
+		u64 primes = 0;
+		u64 disagreements = 0;
+
+		for ( u64 i = 0; i < count; ++i )
+		{
+			primes += scalar[ i ];
+			disagreements += ( scalar[ i ] != batch[ i ] );
+		}
+
+		f64 scalarRate = static_cast<f64>( count ) * frequency / static_cast<f64>( scalarTicks ) / 1000000.0;
+		f64 batchRate = static_cast<f64>( count ) * frequency / static_cast<f64>( batchTicks ) / 1000000.0;
+
+		show_message( "%s: %llu candidates, %llu prime. is_prime %.2f million a second, is_prime_batch %.2f million a second (%.2fx).",
+			set.name, count, primes, scalarRate, batchRate, batchRate / scalarRate );
+
+		if ( disagreements )
+		{
+			show_log_warning( "%s: is_prime_batch disagrees with is_prime on %llu candidates.", set.name, disagreements );
+			agreed = false;
+		}
+	}
+
+	return agreed;
+}
+
+bool verify_prime_file( const char *path )
+{
+	bool valid = false;
+
+	{
+		timer_start();
+
+		valid = prime_file_verify( path, program->threadCount );
+
+		timer_stop();
+	}
+
+	return valid;
+}
+
+bool write_prime_manifest( u32 shardCount, u64 highest )
+{
+	u64 to = sieve_end_inclusive( highest );
+
+	PrimeManifest manifest;
+	prime_manifest_plan( &manifest, to, shardCount, program->primeFileFormat );
+
+	if ( !prime_manifest_write( &manifest, PRIME_MANIFEST_FILE ) )
+		return false;
+
+	show_message( "\n%u shards of the primes up to %llu planned in %s.", shardCount, highest, PRIME_MANIFEST_FILE );
+
+	return true;
+}
+
+bool generate_prime_shard( u64 index )
+{
+	PrimeManifest manifest;
+
+	if ( !prime_manifest_read( &manifest, PRIME_MANIFEST_FILE ) )
+	{
+		show_log_warning( "Plan the shards first (-manifest)." );
+		return false;
+	}
+
+	if ( index >= manifest.shards.size() )
+	{
+		show_log_warning( "There is no shard %llu, %s has %llu.", index, PRIME_MANIFEST_FILE, static_cast<u64>( manifest.shards.size() ) );
+		return false;
+	}
+
+	const PrimeShard &shard = manifest.shards[ index ];
+	PrimeFileAppend append;
+	PrimeFileReader reader;
+	u64 from = shard.low;
+	u32 file = INVALID_FILE_INDEX;
+
+	// A shard left by an interrupted worker carries on from its last checkpoint, like -extend
+	if ( platform_file_exists( shard.path ) )
+	{
+		file = platform_open_file( shard.path, FILE_OPTION_READ | FILE_OPTION_WRITE );
+
+		if ( file != INVALID_FILE_INDEX && ( !prime_file_read_begin( &reader, file ) || reader.header.low != shard.low ||
+			reader.header.format != manifest.format || reader.header.limit > shard.high ) )
+		{
+			show_log_info( "Starting %s again.", shard.path );
+			platform_close_file( file );
+			file = INVALID_FILE_INDEX;
+		}
+	}
+
+	if ( file != INVALID_FILE_INDEX )
+	{
+		if ( reader.header.trailerOffset && reader.header.limit == shard.high )
+		{
+			show_message( "\n%s is already finished.", shard.path );
+			platform_close_file( file );
+			return true;
+		}
+
+		from = reader.header.limit;
+
+		if ( !prime_file_append_resume( &append, &reader, shard.high, program->writerBlockBytes ) )
+		{
+			show_log_warning( "Failed to resize file: %s", shard.path );
+			platform_close_file( file );
+			return false;
+		}
+	}
+	else
+	{
+		file = platform_open_file( shard.path, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+		if ( file == INVALID_FILE_INDEX )
+		{
+			show_log_warning( "Failed to create or open file: %s", shard.path );
+			return false;
+		}
+
+		prime_file_append_begin( &append, file, manifest.format, shard.low, shard.high, program->writerBlockBytes );
+	}
+
+	u64 primeNumbersFound = 0;
+	bool sieved = true;
+
+	{
+		timer_start();
+
+		if ( from < shard.high )
+		{
+			sieved = generate_prime_numbers_engine( from, shard.high, &primeNumbersFound, [&] ( const u64 *primes, u64 count )
+				{
+					prime_file_append( &append, primes, count );
+				} );
+		}
+
+		timer_stop();
+	}
+
+	if ( !sieved )
+	{
+		prime_file_append_cancel( &append );
+		platform_close_file( file );
+		return false;
+	}
+
+	bool written = prime_file_append_end( &append, shard.high );
+
+	platform_close_file( file );
+
+	if ( !written )
+	{
+		show_log_warning( "Failed to write file: %s", shard.path );
+		return false;
+	}
+
+	show_message( "\n%llu Prime Numbers found (%llu - %llu) in %s.", primeNumbersFound, from, shard.high - 1, shard.path );
+
+	return true;
+}
+
+bool merge_prime_shards()
+{
+	PrimeManifest manifest;
+
+	if ( !prime_manifest_read( &manifest, PRIME_MANIFEST_FILE ) )
+	{
+		show_log_warning( "Plan the shards first (-manifest)." );
+		return false;
+	}
+
+	u64 primeNumbersFound = 0;
+	bool merged = false;
+
+	{
+		timer_start();
+
+		merged = prime_shards_merge( &manifest, PRIME_NUMBER_FILE, program->threadCount, program->writerBlockBytes, &primeNumbersFound );
+
+		timer_stop();
+	}
+
+	if ( merged )
+		show_message( "\n%llu Prime Numbers from %llu shards merged into %s (0 - %llu).", primeNumbersFound, static_cast<u64>( manifest.shards.size() ), PRIME_NUMBER_FILE, manifest.to - 1 );
+
+	return merged;
+}
+
+/// @desc -manifest, -shard in local processes and -merge in one go. The processes come from platform_launch_self,
+/// so this is Windows only, other platforms run the three tasks by hand.
+bool generate_prime_shards( u32 shardCount, u64 highest )
+{
+	if ( !write_prime_manifest( shardCount, highest ) )
+		return false;
+
+	// At most one worker per thread runs at a time, the threads are split between them
+	u32 running = ( shardCount < program->threadCount ) ? shardCount : program->threadCount;
+	u32 workerThreads = program->threadCount / running;
+
+	char arguments[ MAX_CONSOLE_INPUT ];
+	std::vector<PlatformProcess> workers( shardCount );
+	u32 failed = 0;
+
+	{
+		timer_start();
+
+		for ( u32 launched = 0, waited = 0; waited < shardCount; )
+		{
+			if ( launched < shardCount && launched - waited < running )
 			{
-				show_log_warning( "Generate some prime numbers first." );
-				return;
+				string_utf8_format( arguments, "-shard %u -engine %s -segment %llu -threads %u -writeblock %llu%s", launched,
+					( program->sieveEngine == SIEVE_ENGINE_ODD ) ? "odd" : "wheel", sieve_segment_bytes( program->sieveEngine ), workerThreads,
+					program->writerBlockBytes, ( program->flags & PROGRAM_FLAG_VERBOSE ) ? " -v" : "" );
+
+				if ( !platform_launch_self( arguments, &workers[ launched ] ) )
+					workers[ launched ] = {};
+
+				++launched;
+				continue;
 			}
 
-			u64 bytesRead = platform_read_from_file( file, &maxValue, sizeof( u64 ) );
-			platform_close_file( file );
+			// Workers are waited on in the order they started, the first shards are no bigger than the rest
+			u32 exitCode = workers[ waited ].process ? platform_wait_process( &workers[ waited ] ) : INVALID_INDEX_UINT_32;
 
-			if ( bytesRead != sizeof( u64 ) || maxValue == 0 )
+			if ( exitCode != RESULT_CODE_SUCCESS )
 			{
-				show_log_warning( "Prime number file corrupted. Regeneerate." );
-				return;
+				show_log_warning( "Shard %u failed (exit code %u).", waited, exitCode );
+				++failed;
 			}
+
+			++waited;
 		}
 
+		timer_stop();
+	}
+
+	if ( failed )
+	{
+		show_log_warning( "%u of %u shards failed, run -shards again to finish them.", failed, shardCount );
+		return false;
+	}
+
+	return merge_prime_shards();
+}
+
+const char *get_positional_ending( u64 value )
+{
+	switch ( value % 10 )
+	{
+	case 1: return "st";
+	case 2: return "nd";
+	case 3: return "rd";
+	}
+
+	return "th";
+}
+
+// -------------------------------------------------------------------------
+void prime_factorisation()
+{
+	while ( true )
+	{
+		// The numbers of the last input were written out in transient memory
+		memory_arena_update( &program->memoryArena );
+
+		u128 minValue = 2;
+		u128 maxValue = U128_MAX;
+
 		bool invalid = true;
-		u64 inputValue = 0;
+		u128 inputValue = 0;
 
 		// Get the input
 		while ( invalid )
 		{
 			show_message( "\nEnter 0 to exit." );
-			show_message_same_line( "Enter a number between %llu and %llu (inclusive):", minValue, maxValue );
+			show_message_same_line( "Enter a number between %s and %s (inclusive):", convert_to_string( minValue ), convert_to_string( maxValue ) );
 
 			const char *input = get_input();
 
 			if ( !input || input[ 0 ] == '0' || input[ 0 ] == '-' || input[ 0 ] == '\0' )
 				return;
 
-			inputValue = convert_to_u64( input );
+			inputValue = convert_to_u128( input );
 
 			invalid = ( inputValue == 0 || inputValue < minValue || inputValue > maxValue );
 
@@ -353,86 +1453,48 @@ void prime_factorisation()
 				show_log_warning( "An error has occured, ensure the input is numeric and within the boundaries." );
 		}
 
-		bool even = ( inputValue & 1 ) == 0;
+		bool even = ( inputValue.low & 1 ) == 0;
 		bool single = true;
-		u64 combinedOccurence = 0;
-
-		std::vector<u64> primesUsed;
-		std::vector<u64> primeFactor;
-		std::vector<u64> occurence;
+		bool complete = true;
+		u128 combinedOccurence = 0;
 
-		primesUsed.reserve( 65536 );
-		primeFactor.reserve( 65536 );
-		occurence.reserve( 65536 );
+		std::vector<u128> primesUsed;
+		std::vector<u128> primeFactor;
+		std::vector<u128> factors;
 
 		// Process
 		show_message( "\nProcessing..." );
 		{
-			int primeNumber = 0;
-
-			u32 file = platform_open_file( PRIME_NUMBER_FILE, FILE_OPTION_READ );
-			if ( file == INVALID_FILE_INDEX )
-			{
-				show_log_warning( "Failed to open prime numbers file." );
-				return;
-			}
-
-			// Read the count first
-			u64 count;
-			platform_read_from_file( file, &count, sizeof( u64 ) );
-
 			timer_start();
 
-			for ( u64 i = 0; i < count; ++i )
-			{
-				platform_read_from_file( file, &primeNumber, sizeof( u64 ) );
+			complete = factorise( inputValue, factors, program->threadCount );
 
-				if ( primeNumber > inputValue )
-					break;
-
-				if ( inputValue % primeNumber == 0 )
-					primesUsed.push_back( primeNumber );
-			}
-
-			platform_close_file( file );
-
-			if ( primesUsed.empty() )
-			{
-				show_log_warning( "Prime number file may be corrupt. Regenerate." );
-				return;
-			}
+			// The distinct primes, ascending
+			for ( u128 factor : factors )
+				if ( primesUsed.empty() || primesUsed.back() != factor )
+					primesUsed.push_back( factor );
 
 			single = ( primesUsed.size() == 1 );
 
-			if ( single )
-			{
-				u64 rem = inputValue;
-
-				single_prime_finding( rem, primeFactor, primesUsed );
-
-				combinedOccurence = inputValue / primeFactor[ 0 ];
-			}
-			else
-			{
-				u64 jumpValue = primesUsed[ 0 ];
+			// Raw find order, each pass divides the remainder once by every distinct prime still dividing it
+			u128 rem = inputValue;
+			u128 jumpValue = 1;
 
-				for ( u64 i = 1, primeCount = primesUsed.size(); i < primeCount; ++i )
-				{
-					occurence.push_back( inputValue / primesUsed[ i ] );
-					jumpValue = jumpValue * primesUsed[ i ];
-				}
-
-				combinedOccurence = inputValue / jumpValue;
+			for ( u128 prime : primesUsed )
+				jumpValue *= prime;
 
-				u64 rem = inputValue;
+			combinedOccurence = inputValue / jumpValue;
 
-				for ( u64 i = 0, primeCount = primesUsed.size(); i < primeCount; ++i )
+			while ( rem != 1 )
+			{
+				for ( u128 prime : primesUsed )
 				{
-					rem = rem / primesUsed[ i ];
-					primeFactor.push_back( primesUsed[ i ] );
+					if ( rem % prime == 0 )
+					{
+						rem /= prime;
+						primeFactor.push_back( prime );
+					}
 				}
-
-				multi_prime_finding( rem, primeFactor, primesUsed );
 			}
 
 			timer_stop();
@@ -446,50 +1508,58 @@ void prime_factorisation()
 		}
 
 		show_message( "\n> Data:" );
-		show_message( "> Input Value: %llu (%s)", inputValue, even ? "even" : "odd" );
+		show_message( "> Input Value: %s (%s)", convert_to_string( inputValue ), even ? "even" : "odd" );
 		show_message( "> Type: %s (%llu)", single ? "Single" : "Multi", primesUsed.size() );
-		show_message_same_line( "> Primes used: %llu", primesUsed[ 0 ] );
+		show_message_same_line( "> Primes used: %s", convert_to_string( primesUsed[ 0 ] ) );
 
 		for ( u64 i = 1, primeCount = primesUsed.size(); i < primeCount; ++i )
-			show_message_same_line( ", %llu", primesUsed[ i ] );
+			show_message_same_line( ", %s", convert_to_string( primesUsed[ i ] ) );
 
 		if ( single )
 		{
-			show_message( "\n> Occurence [%llu]: %llu%s", primesUsed[ 0 ], combinedOccurence, get_positional_ending( combinedOccurence ) );
+			show_message( "\n> Occurence [%s]: %s%s", convert_to_string( primesUsed[ 0 ] ), convert_to_string( combinedOccurence ), get_positional_ending( ( combinedOccurence % 100 ).low ) );
 		}
 		else
 		{
 			show_message( "\n> Occurences:" );
 
-			u64 occur = 0;
+			u128 occur = 0;
 
 			for ( u64 i = 0, primeCount = primesUsed.size(); i < primeCount; ++i )
 			{
 				occur = inputValue / primesUsed[ i ];
-				show_message( " > [%llu]: %llu%s", primesUsed[ i ], occur, get_positional_ending( occur ) );
+				show_message( " > [%s]: %s%s", convert_to_string( primesUsed[ i ] ), convert_to_string( occur ), get_positional_ending( ( occur % 100 ).low ) );
 			}
 
-			show_message_same_line( "> Combined occurence [%llu", primesUsed[ 0 ] );
+			show_message_same_line( "> Combined occurence [%s", convert_to_string( primesUsed[ 0 ] ) );
 
 			for ( u64 i = 1, primeCount = primesUsed.size(); i < primeCount; ++i )
-				show_message_same_line( ".%llu", primesUsed[ i ] );
+				show_message_same_line( ".%s", convert_to_string( primesUsed[ i ] ) );
 
-			show_message( "]: %llu%s", combinedOccurence, get_positional_ending( combinedOccurence ) );
+			show_message( "]: %s%s", convert_to_string( combinedOccurence ), get_positional_ending( ( combinedOccurence % 100 ).low ) );
 		}
 
-		show_message_same_line( "> Prime factors [raw find]: %llu", primeFactor[ 0 ] );
+		show_message_same_line( "> Prime factors [raw find]: %s", convert_to_string( primeFactor[ 0 ] ) );
 
 		for ( u64 i = 1, primeFactorCount = primeFactor.size(); i < primeFactorCount; ++i )
-			show_message_same_line( ".%llu", primeFactor[ i ] );
+			show_message_same_line( ".%s", convert_to_string( primeFactor[ i ] ) );
 
 		std::sort( primeFactor.begin(), primeFactor.end() );
 
-		show_message_same_line( "\n> Prime factors: %llu", primeFactor[ 0 ] );
+		show_message_same_line( "\n> Prime factors: %s", convert_to_string( primeFactor[ 0 ] ) );
 
 		for ( u64 i = 1, primeFactorCount = primeFactor.size(); i < primeFactorCount; ++i )
-			show_message_same_line( ".%llu", primeFactor[ i ] );
+			show_message_same_line( ".%s", convert_to_string( primeFactor[ i ] ) );
 
 		show_message( "" );
+
+		// Rho ran out of steps on a wide cofactor, it is listed as though it were prime
+		if ( !complete )
+		{
+			for ( u128 factor : primesUsed )
+				if ( !is_prime( factor ) )
+					show_log_warning( "%s is composite, no factor of it was found.", convert_to_string( factor ) );
+		}
 	}
 }
 
@@ -508,10 +1578,79 @@ int main( int argc, const char *argv[] )
 
 	// -------------------------------------------------------------------------
 
+	switch ( program->task )
+	{
+	case PROGRAM_TASK_RANGE:
+		if ( !generate_prime_range( program->taskArguments[ 0 ], program->taskArguments[ 1 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_EXTEND:
+		if ( !extend_prime_numbers( program->taskArguments[ 0 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_COUNT:
+		if ( !count_prime_numbers( program->taskArguments[ 0 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_BITMAP:
+		if ( !generate_prime_bitmap( program->taskArguments[ 0 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_TUPLES:
+		if ( !generate_prime_tuples( static_cast<PrimeTuple>( program->taskArguments[ 0 ] ), program->taskArguments[ 1 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_PRIME_BENCHMARK:
+		if ( !benchmark_primality( program->taskArguments[ 0 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_VERIFY:
+		if ( !verify_prime_file( program->taskPath ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_MANIFEST:
+		if ( !write_prime_manifest( static_cast<u32>( program->taskArguments[ 0 ] ), program->taskArguments[ 1 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_SHARD:
+		if ( !generate_prime_shard( program->taskArguments[ 0 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_SHARDS:
+		if ( !generate_prime_shards( static_cast<u32>( program->taskArguments[ 0 ] ), program->taskArguments[ 1 ] ) )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+
+	case PROGRAM_TASK_MERGE:
+		if ( !merge_prime_shards() )
+			program->result = RESULT_CODE_TASK_FAILED;
+		platform_shutdown();
+		break;
+	}
+
 	while ( platform_update() )
 	{
-		show_message( "\n:: Prime Stuff\n:: By Azenris\n:: morleyx22@hotmail.com\n:: only 8 byte numbers." );
-		show_message_same_line( "] 0: Exit Program.\n] 1: Prime Factorisation.\n] 2: Generate Prime Numbers.\n] Selection: " );
+		show_message( "\n:: Prime Stuff\n:: By Azenris\n:: morleyx22@hotmail.com\n:: up to 16 byte numbers." );
+		show_message_same_line( "] 0: Exit Program.\n] 1: Prime Factorisation.\n] 2: Generate Prime Numbers.\n] 3: Generate Prime Numbers In A Range.\n] 4: Extend Prime Numbers.\n] 5: Count Prime Numbers.\n] 6: Generate Prime Bitmap.\n] 7: Look Up Prime Numbers.\n] 8: Generate Prime Tuples.\n] Selection: " );
 
 		int inputValue = convert_to_int( get_input() );
 
@@ -526,19 +1665,108 @@ int main( int argc, const char *argv[] )
 			break;
 
 		case 2:
-			// Generate Prime Numbers
-			show_message_same_line( "\nPlease enter the highest number to check: " );
+			{
+				// Generate Prime Numbers
+				show_message_same_line( "\nPlease enter the highest number to check: " );
+
+				u64 highest = convert_to_u64( get_input() );
 
-			inputValue = convert_to_int( get_input() );
+				if ( highest > 0 )
+				{
+					generate_prime_numbers( highest );
+				}
+				else
+				{
+					show_log_warning( "An error has occured. Invalid number." );
+					platform_shutdown();
+				}
+			}
+			break;
 
-			if ( inputValue > 0 )
+		case 3:
 			{
-				generate_prime_numbers( inputValue );
+				// Generate Prime Numbers In A Range
+				show_message_same_line( "\nPlease enter the lowest number to check: " );
+				u64 low = convert_to_u64( get_input() );
+
+				show_message_same_line( "Please enter the highest number to check: " );
+				u64 high = convert_to_u64( get_input() );
+
+				if ( low <= high )
+				{
+					generate_prime_range( low, high );
+				}
+				else
+				{
+					show_log_warning( "An error has occured. The lowest number must not be above the highest." );
+				}
 			}
-			else
+			break;
+
+		case 4:
+			{
+				// Extend Prime Numbers
+				show_message_same_line( "\nPlease enter the new highest number to check: " );
+
+				u64 highest = convert_to_u64( get_input() );
+
+				if ( highest > 0 )
+					extend_prime_numbers( highest );
+				else
+					show_log_warning( "An error has occured. Invalid number." );
+			}
+			break;
+
+		case 5:
 			{
-				show_log_warning( "An error has occured. Invalid number." );
-				platform_shutdown();
+				// Count Prime Numbers
+				show_message_same_line( "\nPlease enter the highest number to count up to: " );
+
+				u64 highest = convert_to_u64( get_input() );
+
+				count_prime_numbers( highest );
+			}
+			break;
+
+		case 6:
+			{
+				// Generate Prime Bitmap
+				show_message_same_line( "\nPlease enter the highest number to check: " );
+
+				u64 highest = convert_to_u64( get_input() );
+
+				if ( highest > 0 )
+					generate_prime_bitmap( highest );
+				else
+					show_log_warning( "An error has occured. Invalid number." );
+			}
+			break;
+
+		case 7:
+			prime_lookup();
+			break;
+
+		case 8:
+			{
+				// Generate Prime Tuples
+				show_message_same_line( "\nPlease enter the tuple (twins, cousins, sexy, triplets, sophie_germain): " );
+
+				PrimeTuple tuple = prime_tuple_from_name( get_input() );
+
+				if ( tuple == PRIME_TUPLE_COUNT )
+				{
+					show_log_warning( "An error has occured. Unknown tuple." );
+					break;
+				}
+
+				show_message_same_line( "\nPlease enter the highest number to check: " );
+
+				u64 highest = convert_to_u64( get_input() );
+
+				if ( highest > 0 && highest <= PRIME_TUPLE_MAX )
+					generate_prime_tuples( tuple, highest );
+				else
+					show_log_warning( "An error has occured. Invalid number." );
 			}
 			break;
 		}
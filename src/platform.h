@@ -63,11 +63,107 @@ bool platform_seek_in_file( u32 fileID, FileSeek seek, u64 offset );
 u8 *platform_read_whole_file( u32 fileID, MemoryArena *arena, bool addNullTerminator );
 u64 platform_read_from_file( u32 fileID, void *buffer, u64 size );
 u64 platform_write_to_file( u32 fileID, void *buffer, u64 size );
+bool platform_flush_file( u32 fileID );
+bool platform_set_file_size( u32 fileID, u64 size );
+bool platform_preallocate_file( u32 fileID, u64 size );
 [[nodiscard]] inline bool platform_file_exists( const char *path );
 inline bool platform_delete_file( const char *path );
 [[nodiscard]] u64 platform_last_edit_timestamp( const char *path );
 inline void platform_copy_file( const char *from, const char *to );
 
+// File Mapping
+// A read only view of a whole file, pages come from the page cache as they are touched so mapping is the same cost
+// whatever the size, and processes mapping the same file share the pages.
+using FileMapHint = u32;
+enum FILE_MAP_HINT : FileMapHint
+{
+	FILE_MAP_HINT_SEQUENTIAL,				// read front to back, worth reading ahead
+	FILE_MAP_HINT_RANDOM,					// scattered lookups, reading ahead is wasted
+};
+
+struct MappedFile
+{
+	const u8 *data;
+	u64 size;
+	void *file;								// platform handles
+	void *mapping;
+};
+
+/// @desc Maps the whole of path, an empty file can not be mapped
+bool platform_map_file( const char *path, FileMapHint hint, MappedFile *mapped );
+void platform_unmap_file( MappedFile *mapped );
+
+// File Writer
+// Buffered writes to an open file. The data collects in a block, full blocks are queued for a writer thread so the
+// caller can fill the next block while the last one is still going to disk. At most FILE_WRITER_BLOCK_COUNT - 1
+// blocks are in flight, the caller waits for one to come back when they are all out.
+struct FileWriter
+{
+	u32 fileID;
+	std::vector<u8> blocks[ FILE_WRITER_BLOCK_COUNT ];
+	u64 blockUsed[ FILE_WRITER_BLOCK_COUNT ];	// bytes to write from each queued block
+	u64 used;								// bytes waiting in the block being filled
+	u64 submitted;							// blocks handed to the writer thread
+	u64 written;							// blocks the writer thread has finished with
+	bool failed;
+	bool stopping;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable blockQueued;
+	std::condition_variable blockWritten;
+};
+
+void platform_writer_open( FileWriter *writer, u32 fileID, u64 blockSize );
+bool platform_writer_write( FileWriter *writer, const void *data, u64 size );
+/// @desc Waits until everything written so far is in the file, returns false if any of it failed
+bool platform_writer_flush( FileWriter *writer );
+bool platform_writer_close( FileWriter *writer );
+
+// Processor
+// Per core data cache sizes in bytes, 0 when a level is missing or unknown. With cores of different sizes the
+// smallest is kept, a thread can end up on any of them.
+struct CacheSizes
+{
+	u64 l1Data;
+	u64 l2;
+	u64 l3;
+};
+
+bool platform_get_cache_sizes( CacheSizes *sizes );
+
+// Vector instruction sets the processor has and the operating system saves the registers of
+using SimdFeatures = u32;
+enum SIMD_FEATURE : SimdFeatures
+{
+	SIMD_FEATURE_AVX2 = BIT( 0 ),
+	SIMD_FEATURE_AVX512 = BIT( 1 ),			// AVX-512F
+};
+
+[[nodiscard]] SimdFeatures platform_get_simd_features();
+
+// Whether vector code for a set can be built at all, the features above still have to be checked before running it.
+// MSVC takes the intrinsics whatever the /arch, other compilers only when the instruction set is enabled.
+#if defined( _MSC_VER ) || defined( __AVX2__ )
+#	define PLATFORM_AVX2
+#endif
+#if defined( _MSC_VER ) || defined( __AVX512F__ )
+#	define PLATFORM_AVX512
+#endif
+
+// Processes
+// Another copy of this program running alongside, it starts in the current directory. Like the rest of this header it
+// is only implemented by platform_windows.cpp, a POSIX layer would fork, exec /proc/self/exe and waitpid for the status.
+struct PlatformProcess
+{
+	void *process;							// platform handles
+	void *thread;
+};
+
+/// @desc Starts this program again with arguments (everything after the program name on a command line)
+bool platform_launch_self( const char *arguments, PlatformProcess *process );
+/// @desc Waits for the process to finish and lets go of it, returns its exit code (INVALID_INDEX_UINT_32 if unknown)
+u32 platform_wait_process( PlatformProcess *process );
+
 // Logger File
 bool platform_logger_initialisation();
 void platform_logger_message( const char *message, ... );
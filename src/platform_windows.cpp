@@ -503,6 +503,51 @@ u64 platform_write_to_file( u32 fileID, void *buffer, u64 size )
 	return bytesWritten;
 }
 
+bool platform_flush_file( u32 fileID )
+{
+	if ( !FlushFileBuffers( platformData.allOpenFiles[ fileID ] ) )
+	{
+		show_log_warning( "Failed to flush fileID: %d", fileID );
+		return false;
+	}
+
+	return true;
+}
+
+bool platform_set_file_size( u32 fileID, u64 size )
+{
+	HANDLE file = platformData.allOpenFiles[ fileID ];
+
+	LARGE_INTEGER li;
+	li.QuadPart = size;
+
+	if ( !SetFilePointerEx( file, li, nullptr, FILE_BEGIN ) || !SetEndOfFile( file ) )
+	{
+		show_log_warning( "Failed to resize fileID: %d", fileID );
+		return false;
+	}
+
+	return true;
+}
+
+bool platform_preallocate_file( u32 fileID, u64 size )
+{
+	// Shrinking the allocation below the end of the file would truncate it
+	if ( size <= platform_get_file_size( fileID ) )
+		return true;
+
+	FILE_ALLOCATION_INFO info;
+	info.AllocationSize.QuadPart = size;
+
+	if ( !SetFileInformationByHandle( platformData.allOpenFiles[ fileID ], FileAllocationInfo, &info, sizeof( info ) ) )
+	{
+		verbose_log_message( "Failed to preallocate %llu bytes for fileID: %d", size, fileID );
+		return false;
+	}
+
+	return true;
+}
+
 [[nodiscard]] inline bool platform_file_exists( const char *path )
 {
 	DWORD attributes = GetFileAttributes( path );
@@ -543,6 +588,193 @@ inline void platform_copy_file( const char *from, const char *to )
 	}
 }
 
+bool platform_map_file( const char *path, FileMapHint hint, MappedFile *mapped )
+{
+	*mapped = {};
+
+	DWORD flags = ( hint == FILE_MAP_HINT_SEQUENTIAL ) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	HANDLE file = CreateFile( path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, flags, 0 );
+
+	if ( file == INVALID_HANDLE_VALUE )
+	{
+		show_log_warning( "Failed to open file: %s", path );
+		return false;
+	}
+
+	LARGE_INTEGER size;
+
+	if ( !GetFileSizeEx( file, &size ) || size.QuadPart == 0 )
+	{
+		CloseHandle( file );
+		show_log_warning( "Failed to map empty file: %s", path );
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMapping( file, 0, PAGE_READONLY, 0, 0, 0 );
+	void *view = mapping ? MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+
+	if ( !view )
+	{
+		if ( mapping )
+			CloseHandle( mapping );
+
+		CloseHandle( file );
+		show_log_warning( "Failed to map file: %s", path );
+		return false;
+	}
+
+	// The file flags only steer the cache manager, ask for the pages of a sequential view up front as well
+	if ( hint == FILE_MAP_HINT_SEQUENTIAL )
+	{
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = view;
+		range.NumberOfBytes = static_cast<SIZE_T>( size.QuadPart );
+
+		PrefetchVirtualMemory( GetCurrentProcess(), 1, &range, 0 );
+	}
+
+	mapped->data = static_cast<const u8 *>( view );
+	mapped->size = size.QuadPart;
+	mapped->file = file;
+	mapped->mapping = mapping;
+
+	return true;
+}
+
+void platform_unmap_file( MappedFile *mapped )
+{
+	if ( !mapped->data )
+		return;
+
+	UnmapViewOfFile( mapped->data );
+	CloseHandle( mapped->mapping );
+	CloseHandle( mapped->file );
+
+	*mapped = {};
+}
+
+// ---------------------------------------------------
+// Processor
+bool platform_get_cache_sizes( CacheSizes *sizes )
+{
+	*sizes = {};
+
+	DWORD bytes = 0;
+	GetLogicalProcessorInformation( 0, &bytes );
+
+	if ( GetLastError() != ERROR_INSUFFICIENT_BUFFER )
+		return false;
+
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> entries( bytes / sizeof( SYSTEM_LOGICAL_PROCESSOR_INFORMATION ) );
+
+	if ( !GetLogicalProcessorInformation( entries.data(), &bytes ) )
+	{
+		platform_print_error();
+		return false;
+	}
+
+	for ( const SYSTEM_LOGICAL_PROCESSOR_INFORMATION &entry : entries )
+	{
+		if ( entry.Relationship != RelationCache || entry.Cache.Type == CacheInstruction || entry.Cache.Type == CacheTrace )
+			continue;
+
+		u64 *size = nullptr;
+
+		switch ( entry.Cache.Level )
+		{
+		case 1: size = &sizes->l1Data; break;
+		case 2: size = &sizes->l2; break;
+		case 3: size = &sizes->l3; break;
+		}
+
+		if ( size && ( *size == 0 || entry.Cache.Size < *size ) )
+			*size = entry.Cache.Size;
+	}
+
+	return sizes->l1Data != 0;
+}
+
+SimdFeatures platform_get_simd_features()
+{
+	int info[ 4 ];
+	__cpuid( info, 0 );
+
+	if ( info[ 0 ] < 7 )
+		return 0;
+
+	// The operating system has to save the wider registers on a context switch (OSXSAVE, then XCR0)
+	__cpuid( info, 1 );
+
+	if ( !( info[ 2 ] & BIT( 27 ) ) )
+		return 0;
+
+	u64 savedState = _xgetbv( 0 );
+	__cpuidex( info, 7, 0 );
+
+	SimdFeatures features = 0;
+
+	// XMM and YMM state, then the opmask and ZMM state too
+	if ( ( savedState & 0x06 ) == 0x06 && ( info[ 1 ] & BIT( 5 ) ) )
+		features |= SIMD_FEATURE_AVX2;
+
+	if ( ( savedState & 0xE6 ) == 0xE6 && ( info[ 1 ] & BIT( 16 ) ) )
+		features |= SIMD_FEATURE_AVX512;
+
+	return features;
+}
+
+// ---------------------------------------------------
+// Processes
+bool platform_launch_self( const char *arguments, PlatformProcess *process )
+{
+	char path[ MAX_PATH ];
+	DWORD length = GetModuleFileName( 0, path, ARRAY_LENGTH( path ) );
+
+	if ( length == 0 || length == ARRAY_LENGTH( path ) )
+	{
+		show_log_warning( "Failed to find the path of the program." );
+		return false;
+	}
+
+	// CreateProcess can write to the command line, so it gets a copy
+	char commandLine[ MAX_PATH + MAX_CONSOLE_INPUT ];
+	string_utf8_format( commandLine, "\"%s\" %s", path, arguments );
+
+	STARTUPINFO startupInfo = {};
+	startupInfo.cb = sizeof( startupInfo );
+
+	PROCESS_INFORMATION processInfo = {};
+
+	if ( !CreateProcess( path, commandLine, 0, 0, FALSE, 0, 0, 0, &startupInfo, &processInfo ) )
+	{
+		show_log_warning( "Failed to start: %s", commandLine );
+		platform_print_error();
+		return false;
+	}
+
+	process->process = processInfo.hProcess;
+	process->thread = processInfo.hThread;
+
+	return true;
+}
+
+u32 platform_wait_process( PlatformProcess *process )
+{
+	DWORD exitCode = INVALID_INDEX_UINT_32;
+
+	WaitForSingleObject( process->process, INFINITE );
+
+	if ( !GetExitCodeProcess( process->process, &exitCode ) )
+		exitCode = INVALID_INDEX_UINT_32;
+
+	CloseHandle( process->thread );
+	CloseHandle( process->process );
+
+	*process = {};
+
+	return exitCode;
+}
+
 bool platform_logger_initialisation()
 {
 	platform_create_directory( "logs" );
@@ -587,7 +819,8 @@ bool platform_logger_initialisation()
 	Date date = platform_get_local_date();
 
 	char path[ 2048 ];
-	string_utf8_format( path, "logs/log_file__%d_%d_%d__%d_%d_%d.txt", date.day, date.month, date.year, date.hour, date.minute, date.second );
+	// The process id keeps the logs of shard workers started in the same second apart
+	string_utf8_format( path, "logs/log_file__%d_%d_%d__%d_%d_%d__%lu.txt", date.day, date.month, date.year, date.hour, date.minute, date.second, GetCurrentProcessId() );
 
 	HANDLE file = CreateFile( path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, CREATE_ALWAYS, 0, 0 );
 
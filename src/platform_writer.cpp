@@ -0,0 +1,120 @@
+static void platform_writer_thread( FileWriter *writer )
+{
+	while ( true )
+	{
+		u64 index;
+
+		{
+			std::unique_lock<std::mutex> lock( writer->mutex );
+			writer->blockQueued.wait( lock, [&] { return writer->stopping || writer->written < writer->submitted; } );
+
+			if ( writer->written == writer->submitted )
+				return;
+
+			index = writer->written % FILE_WRITER_BLOCK_COUNT;
+		}
+
+		// Blocks go out in the order they were queued, so the file position only ever moves forward
+		u64 size = writer->blockUsed[ index ];
+		bool written = platform_write_to_file( writer->fileID, writer->blocks[ index ].data(), size ) == size;
+
+		{
+			std::lock_guard<std::mutex> lock( writer->mutex );
+
+			if ( !written )
+				writer->failed = true;
+
+			++writer->written;
+		}
+
+		writer->blockWritten.notify_all();
+	}
+}
+
+static bool platform_writer_submit( FileWriter *writer )
+{
+	std::unique_lock<std::mutex> lock( writer->mutex );
+
+	writer->blockUsed[ writer->submitted % FILE_WRITER_BLOCK_COUNT ] = writer->used;
+	++writer->submitted;
+	writer->used = 0;
+
+	writer->blockQueued.notify_one();
+
+	// The next block to fill is free once the writer thread is done with it
+	writer->blockWritten.wait( lock, [&] { return writer->submitted - writer->written < FILE_WRITER_BLOCK_COUNT; } );
+
+	return !writer->failed;
+}
+
+void platform_writer_open( FileWriter *writer, u32 fileID, u64 blockSize )
+{
+	// A single write call has to stay below 4GB
+	if ( blockSize == 0 )
+		blockSize = DEFAULT_FILE_WRITER_BLOCK;
+	else if ( blockSize > MAX_FILE_WRITER_BLOCK )
+		blockSize = MAX_FILE_WRITER_BLOCK;
+
+	writer->fileID = fileID;
+	writer->used = 0;
+	writer->submitted = 0;
+	writer->written = 0;
+	writer->failed = false;
+	writer->stopping = false;
+
+	for ( std::vector<u8> &block : writer->blocks )
+		block.resize( blockSize );
+
+	writer->thread = std::thread( platform_writer_thread, writer );
+}
+
+bool platform_writer_write( FileWriter *writer, const void *data, u64 size )
+{
+	const u8 *bytes = static_cast<const u8 *>( data );
+	u64 blockSize = writer->blocks[ 0 ].size();
+
+	while ( size > 0 )
+	{
+		u8 *block = writer->blocks[ writer->submitted % FILE_WRITER_BLOCK_COUNT ].data();
+		u64 copy = ( blockSize - writer->used < size ) ? blockSize - writer->used : size;
+
+		memcpy( block + writer->used, bytes, copy );
+		writer->used += copy;
+		bytes += copy;
+		size -= copy;
+
+		if ( writer->used == blockSize && !platform_writer_submit( writer ) )
+			return false;
+	}
+
+	return true;
+}
+
+bool platform_writer_flush( FileWriter *writer )
+{
+	if ( writer->used > 0 )
+		platform_writer_submit( writer );
+
+	std::unique_lock<std::mutex> lock( writer->mutex );
+	writer->blockWritten.wait( lock, [&] { return writer->written == writer->submitted; } );
+
+	return !writer->failed;
+}
+
+bool platform_writer_close( FileWriter *writer )
+{
+	bool flushed = platform_writer_flush( writer );
+
+	{
+		std::lock_guard<std::mutex> lock( writer->mutex );
+		writer->stopping = true;
+	}
+
+	writer->blockQueued.notify_one();
+	writer->thread.join();
+
+	for ( std::vector<u8> &block : writer->blocks )
+		std::vector<u8>().swap( block );
+
+	return flushed;
+}
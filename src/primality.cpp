@@ -0,0 +1,772 @@
+// Trial division by the odd primes up to 53 before Miller-Rabin
+static constexpr u32 PRIMALITY_TRIAL_COUNT = 15;
+static_assert( SMALL_PRIMES.primes[ PRIMALITY_TRIAL_COUNT - 1 ] == 53 );
+
+// Bases that leave no strong pseudoprimes below the limit (Jaeschke for 2, 7, 61, Sinclair for the seven)
+static constexpr u64 PRIMALITY_BASES_32[] = { 2, 7, 61 };
+static constexpr u64 PRIMALITY_BASES_32_LIMIT = 4759123141ull;
+static constexpr u64 PRIMALITY_BASES_64[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+
+void montgomery_initialise( Montgomery *montgomery, u64 modulus )
+{
+	montgomery->modulus = modulus;
+
+	// Newton's iteration doubles the correct low bits each step, modulus is its own inverse to 3 bits
+	u64 inverse = modulus;
+	for ( u32 i = 0; i < 5; ++i )
+		inverse *= 2 - modulus * inverse;
+
+	montgomery->inverse = inverse;
+	montgomery->one = ( 0 - modulus ) % modulus;
+
+	// 2^128 by doubling 2^64 another 64 times
+	u64 r2 = montgomery->one;
+
+	for ( u32 i = 0; i < 64; ++i )
+	{
+		u64 doubled = r2 << 1;
+		r2 = ( r2 >= modulus - r2 ) ? r2 - ( modulus - r2 ) : doubled;
+	}
+
+	montgomery->r2 = r2;
+}
+
+[[nodiscard]] inline u64 montgomery_multiply( const Montgomery *montgomery, u64 a, u64 b )
+{
+	u64 high;
+	u64 low = multiply_128( a, b, &high );
+
+	// low - m * modulus is 0 mod 2^64, so the result is the high half of the difference
+	u64 m = low * montgomery->inverse;
+	u64 mHigh;
+	(void)multiply_128( m, montgomery->modulus, &mHigh );
+
+	return ( high >= mHigh ) ? high - mHigh : high - mHigh + montgomery->modulus;
+}
+
+[[nodiscard]] inline u64 montgomery_to( const Montgomery *montgomery, u64 value )
+{
+	return montgomery_multiply( montgomery, value % montgomery->modulus, montgomery->r2 );
+}
+
+[[nodiscard]] inline u64 montgomery_from( const Montgomery *montgomery, u64 value )
+{
+	return montgomery_multiply( montgomery, value, 1 );
+}
+
+u64 montgomery_power( const Montgomery *montgomery, u64 base, u64 exponent )
+{
+	u64 result = montgomery->one;
+
+	for ( ; exponent; exponent >>= 1 )
+	{
+		if ( exponent & 1 )
+			result = montgomery_multiply( montgomery, result, base );
+
+		base = montgomery_multiply( montgomery, base, base );
+	}
+
+	return result;
+}
+
+static bool miller_rabin( const Montgomery *montgomery, u64 base, u64 d, u32 s )
+{
+	u64 value = montgomery->modulus;
+	u64 minusOne = value - montgomery->one;
+
+	base %= value;
+	if ( base == 0 )
+		return true;
+
+	u64 x = montgomery_power( montgomery, montgomery_to( montgomery, base ), d );
+
+	if ( x == montgomery->one || x == minusOne )
+		return true;
+
+	for ( u32 i = 1; i < s; ++i )
+	{
+		x = montgomery_multiply( montgomery, x, x );
+
+		if ( x == minusOne )
+			return true;
+	}
+
+	return false;
+}
+
+/// @desc The checks before Miller-Rabin
+/// @return true when they settle it, prime then holds the answer
+static bool primality_screen( u64 value, bool *prime )
+{
+	*prime = false;
+
+	if ( value < 2 )
+		return true;
+
+	if ( ( value & 1 ) == 0 )
+	{
+		*prime = ( value == 2 );
+		return true;
+	}
+
+	// The table answers for anything it covers
+	if ( value < SMALL_PRIME_LIMIT )
+	{
+		u32 above = small_prime_upper_bound( value );
+		*prime = ( above > 0 && SMALL_PRIMES.primes[ above - 1 ] == value );
+		return true;
+	}
+
+	for ( u32 i = 0; i < PRIMALITY_TRIAL_COUNT; ++i )
+	{
+		if ( trial_divides( SMALL_PRIMES.divisors[ i ], value ) )
+			return true;
+	}
+
+	return false;
+}
+
+bool is_prime( u64 value )
+{
+	bool prime;
+
+	if ( primality_screen( value, &prime ) )
+		return prime;
+
+	// value - 1 = d * 2^s with d odd
+	u32 s = count_trailing_zeros( value - 1 );
+	u64 d = ( value - 1 ) >> s;
+
+	Montgomery montgomery;
+	montgomery_initialise( &montgomery, value );
+
+	if ( value < PRIMALITY_BASES_32_LIMIT )
+	{
+		for ( u64 base : PRIMALITY_BASES_32 )
+			if ( !miller_rabin( &montgomery, base, d, s ) )
+				return false;
+
+		return true;
+	}
+
+	for ( u64 base : PRIMALITY_BASES_64 )
+		if ( !miller_rabin( &montgomery, base, d, s ) )
+			return false;
+
+	return true;
+}
+
+// -------------------------------------------------------------------------
+// 128 bit
+
+// The trial primes multiplied together still fit a u64, a u128 is reduced by it once and the remainder tested
+static constexpr u64 PRIMALITY_TRIAL_PRODUCT = [] ()
+	{
+		u64 product = 1;
+		for ( u32 i = 0; i < PRIMALITY_TRIAL_COUNT; ++i )
+			product *= SMALL_PRIMES.primes[ i ];
+
+		return product;
+	}();
+
+// How many values of P the Lucas test tries before checking the value is not a square, which has none
+static constexpr u32 PRIMALITY_SQUARE_CHECK_TRIES = 8;
+
+// The sums and differences of residues are as likely to wrap as not, so they are corrected with masks rather than
+// branches the predictor would miss half the time
+
+[[nodiscard]] inline u128 montgomery_add( const Montgomery128 *montgomery, u128 a, u128 b )
+{
+	u8 carry = 0;
+	u64 low = add_with_carry( a.low, b.low, &carry );
+	u64 high = add_with_carry( a.high, b.high, &carry );
+
+	u8 borrow = 0;
+	u64 reducedLow = subtract_with_borrow( low, montgomery->modulus.low, &borrow );
+	u64 reducedHigh = subtract_with_borrow( high, montgomery->modulus.high, &borrow );
+
+	// The sum stays when it is below the modulus without a carry out of the top
+	u64 keep = 0 - static_cast<u64>( borrow & ( carry ^ 1 ) );
+
+	return mask_select( keep, u128( high, low ), u128( reducedHigh, reducedLow ) );
+}
+
+[[nodiscard]] inline u128 montgomery_subtract( const Montgomery128 *montgomery, u128 a, u128 b )
+{
+	u8 borrow = 0;
+	u64 low = subtract_with_borrow( a.low, b.low, &borrow );
+	u64 high = subtract_with_borrow( a.high, b.high, &borrow );
+
+	// The modulus goes back on when it went below 0
+	u64 mask = 0 - static_cast<u64>( borrow );
+	u8 carry = 0;
+	low = add_with_carry( low, montgomery->modulus.low & mask, &carry );
+	high = add_with_carry( high, montgomery->modulus.high & mask, &carry );
+
+	return u128( high, low );
+}
+
+void montgomery_initialise( Montgomery128 *montgomery, u128 modulus )
+{
+	montgomery->modulus = modulus;
+
+	// The inverse of the low half to 64 bits, then one more step of Newton's iteration takes it to 128
+	u64 inverse = modulus.low;
+	for ( u32 i = 0; i < 5; ++i )
+		inverse *= 2 - modulus.low * inverse;
+
+	montgomery->inverse = u128( inverse ) * ( u128( 2 ) - modulus * u128( inverse ) );
+	montgomery->one = ( u128( 0 ) - modulus ) % modulus;
+
+	// 2 in Montgomery form squared 7 times is 2^128 in Montgomery form, which is 2^256 mod modulus
+	u128 r2 = montgomery_add( montgomery, montgomery->one, montgomery->one );
+
+	for ( u32 i = 0; i < 7; ++i )
+		r2 = montgomery_multiply( montgomery, r2, r2 );
+
+	montgomery->r2 = r2;
+}
+
+[[nodiscard]] inline u128 montgomery_multiply( const Montgomery128 *montgomery, u128 a, u128 b )
+{
+	u128 high;
+	u128 low = multiply_256( a, b, &high );
+
+	// low - m * modulus is 0 mod 2^128, so the result is the high half of the difference
+	u128 m = low * montgomery->inverse;
+	u128 mHigh;
+	(void)multiply_256( m, montgomery->modulus, &mHigh );
+
+	return montgomery_subtract( montgomery, high, mHigh );
+}
+
+[[nodiscard]] inline u128 montgomery_to( const Montgomery128 *montgomery, u128 value )
+{
+	return montgomery_multiply( montgomery, value % montgomery->modulus, montgomery->r2 );
+}
+
+[[nodiscard]] inline u128 montgomery_from( const Montgomery128 *montgomery, u128 value )
+{
+	return montgomery_multiply( montgomery, value, 1 );
+}
+
+u128 montgomery_power( const Montgomery128 *montgomery, u128 base, u128 exponent )
+{
+	u128 result = montgomery->one;
+
+	for ( ; exponent != 0; exponent >>= 1 )
+	{
+		if ( exponent.low & 1 )
+			result = montgomery_multiply( montgomery, result, base );
+
+		base = montgomery_multiply( montgomery, base, base );
+	}
+
+	return result;
+}
+
+/// @desc Jacobi symbol ( a / n ) for an odd n
+[[nodiscard]] static i32 jacobi_symbol( u64 a, u64 n )
+{
+	i32 result = 1;
+	a %= n;
+
+	while ( a )
+	{
+		u32 twos = count_trailing_zeros( a );
+		a >>= twos;
+
+		// ( 2 / n ) is -1 for n = 3 or 5 mod 8
+		if ( ( twos & 1 ) && ( ( n & 7 ) == 3 || ( n & 7 ) == 5 ) )
+			result = -result;
+
+		// Reciprocity, the sign changes when both are 3 mod 4
+		if ( ( a & 3 ) == 3 && ( n & 3 ) == 3 )
+			result = -result;
+
+		u64 swap = a;
+		a = n % a;
+		n = swap;
+	}
+
+	return ( n == 1 ) ? result : 0;
+}
+
+/// @desc Jacobi symbol ( a / n ) for an odd n above a, one step by hand and the rest in u64
+[[nodiscard]] static i32 jacobi_symbol( u64 a, u128 n )
+{
+	i32 result = 1;
+	u32 twos = count_trailing_zeros( a );
+	a >>= twos;
+
+	if ( ( twos & 1 ) && ( ( n.low & 7 ) == 3 || ( n.low & 7 ) == 5 ) )
+		result = -result;
+
+	if ( ( a & 3 ) == 3 && ( n.low & 3 ) == 3 )
+		result = -result;
+
+	return result * jacobi_symbol( ( n % a ).low, a );
+}
+
+/// @desc Extra strong Lucas probable prime test with Q = 1 and P the first of 3, 4, 5, ... with ( P^2 - 4 / value ) = -1.
+/// value is odd, above 2^64 and has no factor up to the trial primes.
+[[nodiscard]] static bool lucas_extra_strong( const Montgomery128 *montgomery, u128 value )
+{
+	u64 p = 3;
+
+	for ( u32 tries = 1; ; ++tries, ++p )
+	{
+		i32 jacobi = jacobi_symbol( p * p - 4, value );
+
+		if ( jacobi == -1 )
+			break;
+
+		// A factor in common with P^2 - 4, far below value
+		if ( jacobi == 0 )
+			return false;
+
+		if ( tries == PRIMALITY_SQUARE_CHECK_TRIES )
+		{
+			u64 root = integer_sqrt( value );
+			u64 squareHigh;
+			u64 squareLow = multiply_128( root, root, &squareHigh );
+
+			if ( u128( squareHigh, squareLow ) == value )
+				return false;
+		}
+	}
+
+	// value + 1 = k * 2^s with k odd, value is below 2^128 - 1 as that is a multiple of 3
+	u128 k = value + 1;
+	u32 s = count_trailing_zeros( k );
+	k >>= s;
+
+	u128 two = montgomery_add( montgomery, montgomery->one, montgomery->one );
+	u128 minusTwo = montgomery_subtract( montgomery, 0, two );
+	u128 pm = montgomery_to( montgomery, p );
+
+	// With Q = 1 the V sequence alone steps down the bits of k, V_j and V_j+1 at a time:
+	// V_2j = V_j^2 - 2, V_2j+1 = V_j V_j+1 - P
+	u128 v = two;
+	u128 next = pm;
+
+	for ( u32 bit = 128 - count_leading_zeros( k ); bit-- > 0; )
+	{
+		// A set bit squares V_j+1 into V_2j+2, a clear one V_j into V_2j, chosen by mask as the bits are random
+		u64 set = 0 - ( ( k >> bit ).low & 1 );
+		u128 squared = mask_select( set, next, v );
+
+		u128 middle = montgomery_subtract( montgomery, montgomery_multiply( montgomery, v, next ), pm );
+		u128 square = montgomery_subtract( montgomery, montgomery_multiply( montgomery, squared, squared ), two );
+
+		v = mask_select( set, middle, square );
+		next = mask_select( set, square, middle );
+	}
+
+	// U_k = ( 2 V_k+1 - P V_k ) / D, so U_k = 0 comes down to 2 V_k+1 = P V_k
+	if ( v == two || v == minusTwo )
+	{
+		if ( montgomery_add( montgomery, next, next ) == montgomery_multiply( montgomery, pm, v ) )
+			return true;
+	}
+
+	// V_k 2^r = 0 for r below s - 1
+	for ( u32 r = 0; r + 1 < s; ++r )
+	{
+		if ( v == 0 )
+			return true;
+
+		v = montgomery_subtract( montgomery, montgomery_multiply( montgomery, v, v ), two );
+	}
+
+	return false;
+}
+
+bool is_prime( u128 value )
+{
+	if ( value.high == 0 )
+		return is_prime( value.low );
+
+	if ( ( value.low & 1 ) == 0 )
+		return false;
+
+	u64 remainder = ( value % PRIMALITY_TRIAL_PRODUCT ).low;
+
+	for ( u32 i = 0; i < PRIMALITY_TRIAL_COUNT; ++i )
+	{
+		if ( trial_divides( SMALL_PRIMES.divisors[ i ], remainder ) )
+			return false;
+	}
+
+	Montgomery128 montgomery;
+	montgomery_initialise( &montgomery, value );
+
+	// Strong probable prime to base 2, value - 1 = d * 2^s with d odd. Down the bits of d the multiplications by
+	// the base are doublings, so only the squarings cost a product.
+	u128 minusOne = value - montgomery.one;
+	u32 s = count_trailing_zeros( value - 1 );
+	u128 d = ( value - 1 ) >> s;
+	u128 x = montgomery_add( &montgomery, montgomery.one, montgomery.one );
+
+	for ( u32 bit = 127 - count_leading_zeros( d ); bit-- > 0; )
+	{
+		x = montgomery_multiply( &montgomery, x, x );
+		x = montgomery_add( &montgomery, x, mask_select( 0 - ( ( d >> bit ).low & 1 ), x, 0 ) );
+	}
+
+	if ( x != montgomery.one && x != minusOne )
+	{
+		u32 i = 1;
+
+		for ( ; i < s; ++i )
+		{
+			x = montgomery_multiply( &montgomery, x, x );
+
+			if ( x == minusOne )
+				break;
+		}
+
+		if ( i == s )
+			return false;
+	}
+
+	return lucas_extra_strong( &montgomery, value );
+}
+
+// -------------------------------------------------------------------------
+// Batches
+
+/// @desc Miller-Rabin of a full set of lanes with each base, composite[ i ] is set for values[ i ] failing any.
+/// Every value is above every base.
+using PrimalityLanesTest = void( * )( const u64 *values, const u64 *bases, u32 baseCount, u8 *composite );
+
+// Values waiting for a stage of bases
+struct PrimalityQueue
+{
+	const u64 *bases;
+	u32 baseCount;
+	u32 lanes;								// values tested together
+	PrimalityLanesTest test;
+	PrimalityQueue *next;					// stage the values that pass go to, nullptr when they are prime
+	u32 count;
+	u64 values[ PRIMALITY_BATCH_MAX_LANES ];
+	u64 indices[ PRIMALITY_BATCH_MAX_LANES ];	// where the answer goes
+};
+
+static void primality_lanes_scalar( const u64 *values, const u64 *bases, u32 baseCount, u8 *composite )
+{
+	constexpr u32 LANES = PRIMALITY_BATCH_SCALAR_LANES;
+
+	Montgomery montgomery[ LANES ];
+	u64 d[ LANES ];
+	u32 s[ LANES ];
+	u64 minusOne[ LANES ];
+	u64 exponents = 0;
+	u32 squarings = 0;
+
+	for ( u32 lane = 0; lane < LANES; ++lane )
+	{
+		montgomery_initialise( &montgomery[ lane ], values[ lane ] );
+		s[ lane ] = count_trailing_zeros( values[ lane ] - 1 );
+		d[ lane ] = ( values[ lane ] - 1 ) >> s[ lane ];
+		minusOne[ lane ] = values[ lane ] - montgomery[ lane ].one;
+		composite[ lane ] = 0;
+
+		exponents |= d[ lane ];
+		squarings = ( s[ lane ] > squarings ) ? s[ lane ] : squarings;
+	}
+
+	u32 bits = 64 - count_leading_zeros( exponents );
+
+	// The lanes step through the same bits together, the multiplications of one lane don't wait on another's
+	for ( u32 b = 0; b < baseCount; ++b )
+	{
+		u64 x[ LANES ];
+		u64 power[ LANES ];
+		bool pass[ LANES ];
+
+		for ( u32 lane = 0; lane < LANES; ++lane )
+		{
+			x[ lane ] = montgomery[ lane ].one;
+			power[ lane ] = montgomery_to( &montgomery[ lane ], bases[ b ] );
+		}
+
+		for ( u32 bit = 0; bit < bits; ++bit )
+		{
+			for ( u32 lane = 0; lane < LANES; ++lane )
+			{
+				// A mask rather than a branch, the bits of d are random
+				u64 take = 0 - ( ( d[ lane ] >> bit ) & 1 );
+				u64 product = montgomery_multiply( &montgomery[ lane ], x[ lane ], power[ lane ] );
+				x[ lane ] = ( product & take ) | ( x[ lane ] & ~take );
+				power[ lane ] = montgomery_multiply( &montgomery[ lane ], power[ lane ], power[ lane ] );
+			}
+		}
+
+		for ( u32 lane = 0; lane < LANES; ++lane )
+			pass[ lane ] = ( x[ lane ] == montgomery[ lane ].one || x[ lane ] == minusOne[ lane ] );
+
+		for ( u32 i = 1; i < squarings; ++i )
+		{
+			for ( u32 lane = 0; lane < LANES; ++lane )
+			{
+				x[ lane ] = montgomery_multiply( &montgomery[ lane ], x[ lane ], x[ lane ] );
+				pass[ lane ] = pass[ lane ] || ( i < s[ lane ] && x[ lane ] == minusOne[ lane ] );
+			}
+		}
+
+		for ( u32 lane = 0; lane < LANES; ++lane )
+			composite[ lane ] |= !pass[ lane ];
+	}
+}
+
+// Values below 2^32 one per 64 bit lane, in Montgomery form with R = 2^32
+struct PrimalityLanes32
+{
+	alignas( 64 ) u64 modulus[ PRIMALITY_BATCH_MAX_LANES ];
+	alignas( 64 ) u64 inverse[ PRIMALITY_BATCH_MAX_LANES ];	// modulus^-1 mod 2^32
+	alignas( 64 ) u64 one[ PRIMALITY_BATCH_MAX_LANES ];
+	alignas( 64 ) u64 minusOne[ PRIMALITY_BATCH_MAX_LANES ];
+	alignas( 64 ) u64 exponent[ PRIMALITY_BATCH_MAX_LANES ];	// d of modulus - 1 = d * 2^s
+	alignas( 64 ) u64 squarings[ PRIMALITY_BATCH_MAX_LANES ];	// s
+	alignas( 64 ) u64 power[ PRIMALITY_BATCH_MAX_LANES ];		// the base being tried
+	u32 bits;								// of the largest exponent
+	u32 maxSquarings;
+};
+
+[[maybe_unused]] static void primality_lanes_32_initialise( PrimalityLanes32 *lanes, const u64 *values, u32 count )
+{
+	u64 exponents = 0;
+	lanes->maxSquarings = 0;
+
+	for ( u32 lane = 0; lane < count; ++lane )
+	{
+		u64 modulus = values[ lane ];
+		u32 inverse = static_cast<u32>( modulus );
+
+		for ( u32 i = 0; i < 4; ++i )
+			inverse *= 2 - static_cast<u32>( modulus ) * inverse;
+
+		u32 s = count_trailing_zeros( modulus - 1 );
+
+		lanes->modulus[ lane ] = modulus;
+		lanes->inverse[ lane ] = inverse;
+		lanes->one[ lane ] = ( 1ull << 32 ) % modulus;
+		lanes->minusOne[ lane ] = modulus - lanes->one[ lane ];
+		lanes->exponent[ lane ] = ( modulus - 1 ) >> s;
+		lanes->squarings[ lane ] = s;
+
+		exponents |= lanes->exponent[ lane ];
+		lanes->maxSquarings = ( s > lanes->maxSquarings ) ? s : lanes->maxSquarings;
+	}
+
+	lanes->bits = 64 - count_leading_zeros( exponents );
+}
+
+[[maybe_unused]] static void primality_lanes_32_base( PrimalityLanes32 *lanes, u64 base, u32 count )
+{
+	for ( u32 lane = 0; lane < count; ++lane )
+		lanes->power[ lane ] = ( base << 32 ) % lanes->modulus[ lane ];
+}
+
+#ifdef PLATFORM_AVX2
+static void primality_lanes_avx2( const u64 *values, const u64 *bases, u32 baseCount, u8 *composite )
+{
+	PrimalityLanes32 lanes;
+	primality_lanes_32_initialise( &lanes, values, 4 );
+
+	const __m256i modulus = _mm256_load_si256( reinterpret_cast<const __m256i *>( lanes.modulus ) );
+	const __m256i inverse = _mm256_load_si256( reinterpret_cast<const __m256i *>( lanes.inverse ) );
+	const __m256i one = _mm256_load_si256( reinterpret_cast<const __m256i *>( lanes.one ) );
+	const __m256i minusOne = _mm256_load_si256( reinterpret_cast<const __m256i *>( lanes.minusOne ) );
+	const __m256i squarings = _mm256_load_si256( reinterpret_cast<const __m256i *>( lanes.squarings ) );
+	const __m256i lowBit = _mm256_set1_epi64x( 1 );
+
+	// a * b - m * modulus is 0 mod 2^32 for m = a * b * modulus^-1, so the result is the high half of the difference
+	auto multiply = [&] ( __m256i a, __m256i b )
+		{
+			__m256i product = _mm256_mul_epu32( a, b );
+			__m256i m = _mm256_mul_epu32( product, inverse );
+			__m256i high = _mm256_srli_epi64( product, 32 );
+			__m256i mHigh = _mm256_srli_epi64( _mm256_mul_epu32( m, modulus ), 32 );
+			__m256i difference = _mm256_sub_epi64( high, mHigh );
+
+			return _mm256_add_epi64( difference, _mm256_and_si256( _mm256_cmpgt_epi64( mHigh, high ), modulus ) );
+		};
+
+	__m256i failed = _mm256_setzero_si256();
+
+	for ( u32 b = 0; b < baseCount; ++b )
+	{
+		primality_lanes_32_base( &lanes, bases[ b ], 4 );
+
+		__m256i power = _mm256_load_si256( reinterpret_cast<const __m256i *>( lanes.power ) );
+		__m256i exponent = _mm256_load_si256( reinterpret_cast<const __m256i *>( lanes.exponent ) );
+		__m256i x = one;
+
+		for ( u32 bit = 0; bit < lanes.bits; ++bit )
+		{
+			__m256i take = _mm256_cmpeq_epi64( _mm256_and_si256( exponent, lowBit ), lowBit );
+			x = _mm256_blendv_epi8( x, multiply( x, power ), take );
+			power = multiply( power, power );
+			exponent = _mm256_srli_epi64( exponent, 1 );
+		}
+
+		__m256i pass = _mm256_or_si256( _mm256_cmpeq_epi64( x, one ), _mm256_cmpeq_epi64( x, minusOne ) );
+
+		for ( u32 i = 1; i < lanes.maxSquarings; ++i )
+		{
+			x = multiply( x, x );
+			__m256i squaring = _mm256_cmpgt_epi64( squarings, _mm256_set1_epi64x( i ) );
+			pass = _mm256_or_si256( pass, _mm256_and_si256( squaring, _mm256_cmpeq_epi64( x, minusOne ) ) );
+		}
+
+		failed = _mm256_or_si256( failed, _mm256_andnot_si256( pass, _mm256_set1_epi64x( -1 ) ) );
+	}
+
+	u32 failedLanes = static_cast<u32>( _mm256_movemask_pd( _mm256_castsi256_pd( failed ) ) );
+
+	for ( u32 lane = 0; lane < 4; ++lane )
+		composite[ lane ] = ( failedLanes >> lane ) & 1;
+}
+#endif
+
+#ifdef PLATFORM_AVX512
+static void primality_lanes_avx512( const u64 *values, const u64 *bases, u32 baseCount, u8 *composite )
+{
+	PrimalityLanes32 lanes;
+	primality_lanes_32_initialise( &lanes, values, 8 );
+
+	const __m512i modulus = _mm512_load_si512( lanes.modulus );
+	const __m512i inverse = _mm512_load_si512( lanes.inverse );
+	const __m512i one = _mm512_load_si512( lanes.one );
+	const __m512i minusOne = _mm512_load_si512( lanes.minusOne );
+	const __m512i squarings = _mm512_load_si512( lanes.squarings );
+	const __m512i lowBit = _mm512_set1_epi64( 1 );
+
+	// As primality_lanes_avx2, with mask registers for the comparisons
+	auto multiply = [&] ( __m512i a, __m512i b )
+		{
+			__m512i product = _mm512_mul_epu32( a, b );
+			__m512i m = _mm512_mul_epu32( product, inverse );
+			__m512i high = _mm512_srli_epi64( product, 32 );
+			__m512i mHigh = _mm512_srli_epi64( _mm512_mul_epu32( m, modulus ), 32 );
+			__m512i difference = _mm512_sub_epi64( high, mHigh );
+
+			return _mm512_mask_add_epi64( difference, _mm512_cmpgt_epu64_mask( mHigh, high ), difference, modulus );
+		};
+
+	__mmask8 failed = 0;
+
+	for ( u32 b = 0; b < baseCount; ++b )
+	{
+		primality_lanes_32_base( &lanes, bases[ b ], 8 );
+
+		__m512i power = _mm512_load_si512( lanes.power );
+		__m512i exponent = _mm512_load_si512( lanes.exponent );
+		__m512i x = one;
+
+		for ( u32 bit = 0; bit < lanes.bits; ++bit )
+		{
+			x = _mm512_mask_blend_epi64( _mm512_test_epi64_mask( exponent, lowBit ), x, multiply( x, power ) );
+			power = multiply( power, power );
+			exponent = _mm512_srli_epi64( exponent, 1 );
+		}
+
+		__mmask8 pass = _mm512_cmpeq_epu64_mask( x, one ) | _mm512_cmpeq_epu64_mask( x, minusOne );
+
+		for ( u32 i = 1; i < lanes.maxSquarings; ++i )
+		{
+			x = multiply( x, x );
+			pass |= _mm512_cmpgt_epu64_mask( squarings, _mm512_set1_epi64( i ) ) & _mm512_cmpeq_epu64_mask( x, minusOne );
+		}
+
+		failed |= static_cast<__mmask8>( ~pass );
+	}
+
+	for ( u32 lane = 0; lane < 8; ++lane )
+		composite[ lane ] = ( failed >> lane ) & 1;
+}
+#endif
+
+static void primality_queue_push( PrimalityQueue *queue, u64 value, u64 index, u8 *out );
+
+static void primality_queue_flush( PrimalityQueue *queue, u8 *out )
+{
+	if ( queue->count == 0 )
+		return;
+
+	// Spare lanes repeat the first value, their answers are dropped
+	for ( u32 lane = queue->count; lane < queue->lanes; ++lane )
+		queue->values[ lane ] = queue->values[ 0 ];
+
+	u8 composite[ PRIMALITY_BATCH_MAX_LANES ];
+	queue->test( queue->values, queue->bases, queue->baseCount, composite );
+
+	u32 count = queue->count;
+	queue->count = 0;
+
+	for ( u32 lane = 0; lane < count; ++lane )
+	{
+		if ( composite[ lane ] )
+			out[ queue->indices[ lane ] ] = 0;
+		else if ( queue->next )
+			primality_queue_push( queue->next, queue->values[ lane ], queue->indices[ lane ], out );
+		else
+			out[ queue->indices[ lane ] ] = 1;
+	}
+}
+
+static void primality_queue_push( PrimalityQueue *queue, u64 value, u64 index, u8 *out )
+{
+	queue->values[ queue->count ] = value;
+	queue->indices[ queue->count ] = index;
+
+	if ( ++queue->count == queue->lanes )
+		primality_queue_flush( queue, out );
+}
+
+void is_prime_batch( const u64 *in, u8 *out, u64 n )
+{
+	static const SimdFeatures features = platform_get_simd_features();
+
+	PrimalityLanesTest narrowTest = primality_lanes_scalar;
+	u32 narrowLanes = PRIMALITY_BATCH_SCALAR_LANES;
+
+#ifdef PLATFORM_AVX2
+	if ( features & SIMD_FEATURE_AVX2 )
+	{
+		narrowTest = primality_lanes_avx2;
+		narrowLanes = 4;
+	}
+#endif
+#ifdef PLATFORM_AVX512
+	if ( features & SIMD_FEATURE_AVX512 )
+	{
+		narrowTest = primality_lanes_avx512;
+		narrowLanes = 8;
+	}
+#endif
+
+	// Base 2 for everything, then the rest of the bases for what passes it. Below 2^32 the three bases are enough.
+	PrimalityQueue narrowRest = { PRIMALITY_BASES_32 + 1, ARRAY_LENGTH( PRIMALITY_BASES_32 ) - 1, narrowLanes, narrowTest, nullptr };
+	PrimalityQueue narrow = { PRIMALITY_BASES_32, 1, narrowLanes, narrowTest, &narrowRest };
+	PrimalityQueue wideRest = { PRIMALITY_BASES_64 + 1, ARRAY_LENGTH( PRIMALITY_BASES_64 ) - 1, PRIMALITY_BATCH_SCALAR_LANES, primality_lanes_scalar, nullptr };
+	PrimalityQueue wide = { PRIMALITY_BASES_64, 1, PRIMALITY_BATCH_SCALAR_LANES, primality_lanes_scalar, &wideRest };
+
+	for ( u64 i = 0; i < n; ++i )
+	{
+		bool prime;
+
+		if ( primality_screen( in[ i ], &prime ) )
+			out[ i ] = prime;
+		else
+			primality_queue_push( ( in[ i ] >> 32 ) ? &wide : &narrow, in[ i ], i, out );
+	}
+
+	// What is left, each first stage before the stage it feeds
+	primality_queue_flush( &narrow, out );
+	primality_queue_flush( &narrowRest, out );
+	primality_queue_flush( &wide, out );
+	primality_queue_flush( &wideRest, out );
+}
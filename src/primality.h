@@ -0,0 +1,54 @@
+#pragma once
+
+// Montgomery arithmetic modulo an odd u64, values are kept as value * 2^64 mod modulus so a product
+// is reduced with two multiplications instead of a 128 bit division.
+struct Montgomery
+{
+	u64 modulus;
+	u64 inverse;							// modulus^-1 mod 2^64
+	u64 one;								// 2^64 mod modulus, 1 in Montgomery form
+	u64 r2;									// 2^128 mod modulus, converts into Montgomery form
+};
+
+void montgomery_initialise( Montgomery *montgomery, u64 modulus );
+[[nodiscard]] inline u64 montgomery_multiply( const Montgomery *montgomery, u64 a, u64 b );
+[[nodiscard]] inline u64 montgomery_to( const Montgomery *montgomery, u64 value );
+[[nodiscard]] inline u64 montgomery_from( const Montgomery *montgomery, u64 value );
+[[nodiscard]] u64 montgomery_power( const Montgomery *montgomery, u64 base, u64 exponent );
+
+/// @desc Deterministic for every u64, trial division by a few small primes then Miller-Rabin
+[[nodiscard]] bool is_prime( u64 value );
+
+// Montgomery arithmetic modulo an odd u128 in the same way, values are kept as value * 2^128 mod modulus and a
+// product takes a 256 bit multiplication. Sums are reduced as they go, the modulus can use all 128 bits.
+struct Montgomery128
+{
+	u128 modulus;
+	u128 inverse;							// modulus^-1 mod 2^128
+	u128 one;								// 2^128 mod modulus, 1 in Montgomery form
+	u128 r2;								// 2^256 mod modulus, converts into Montgomery form
+};
+
+void montgomery_initialise( Montgomery128 *montgomery, u128 modulus );
+[[nodiscard]] inline u128 montgomery_multiply( const Montgomery128 *montgomery, u128 a, u128 b );
+[[nodiscard]] inline u128 montgomery_add( const Montgomery128 *montgomery, u128 a, u128 b );
+[[nodiscard]] inline u128 montgomery_subtract( const Montgomery128 *montgomery, u128 a, u128 b );
+[[nodiscard]] inline u128 montgomery_to( const Montgomery128 *montgomery, u128 value );
+[[nodiscard]] inline u128 montgomery_from( const Montgomery128 *montgomery, u128 value );
+[[nodiscard]] u128 montgomery_power( const Montgomery128 *montgomery, u128 base, u128 exponent );
+
+/// @desc Values that fit a u64 go to the deterministic test. Above that it is Baillie-PSW: trial division, a strong
+/// probable prime test to base 2 and an extra strong Lucas probable prime test (Q = 1, so the Lucas sequence needs no
+/// powers of Q and costs two products a bit). No composite is known to pass both.
+[[nodiscard]] bool is_prime( u128 value );
+
+// Batches of unrelated values run Miller-Rabin on several values at once. Values below 2^32 go through 32 bit
+// Montgomery multiplication in the lanes of AVX-512 (8) or AVX2 (4) registers when the processor has them. Wider
+// values, and everything without them, go 4 at a time through interleaved scalar Montgomery chains so the
+// multiplier always has independent work. Every value takes base 2 first, only the few that pass it are queued
+// for the remaining bases, so the lanes are not held up by the composites.
+#define PRIMALITY_BATCH_MAX_LANES				( 8 )
+#define PRIMALITY_BATCH_SCALAR_LANES			( 4 )
+
+/// @desc out[ i ] = is_prime( in[ i ] ) for each of the n values
+void is_prime_batch( const u64 *in, u8 *out, u64 n );
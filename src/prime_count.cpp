@@ -0,0 +1,469 @@
+static u64 prime_count_sieve( u64 x )
+{
+	WheelSieve sieve;
+	sieve_initialise( &sieve, 0, x + 1, DEFAULT_SIEVE_SEGMENT_BYTES );
+
+	std::vector<u64> primes( sieve_segment_capacity( &sieve ) );
+	u64 count = 0;
+
+	while ( !sieve_finished( &sieve ) )
+		count += sieve_next_segment( &sieve, primes.data() );
+
+	return count;
+}
+
+static void prime_count_tables( PrimeCount *count )
+{
+	u64 y = count->y;
+	u64 sqrtZ = integer_sqrt( count->z );
+
+	sieve_small_primes( static_cast<u32>( y > sqrtZ ? y : sqrtZ ), count->oddPrimes );
+
+	count->primes.assign( 2, 0 );
+	count->primes[ 1 ] = 2;
+
+	for ( u32 p : count->oddPrimes )
+	{
+		if ( p > y )
+			break;
+
+		count->primes.push_back( p );
+	}
+
+	count->pi.assign( y + 1, 0 );
+
+	for ( u64 n = 2, b = 1; n <= y; ++n )
+	{
+		if ( b < count->primes.size() && count->primes[ b ] == n )
+			++b;
+
+		count->pi[ n ] = static_cast<u32>( b - 1 );
+	}
+
+	// Fill in the least prime factor and flip the sign for every prime factor, square factors zero it
+	count->muLpf.assign( y + 1, 1 );
+	count->muLpf[ 1 ] = INT32_MAX;
+
+	for ( u64 b = 1; b < count->primes.size(); ++b )
+	{
+		i32 p = static_cast<i32>( count->primes[ b ] );
+
+		for ( u64 n = p; n <= y; n += p )
+		{
+			i32 value = count->muLpf[ n ];
+
+			if ( value == 1 || value == -1 )
+				value *= p;
+
+			count->muLpf[ n ] = -value;
+		}
+
+		for ( u64 n = static_cast<u64>( p ) * p; n <= y; n += static_cast<u64>( p ) * p )
+			count->muLpf[ n ] = 0;
+	}
+}
+
+// Ordinary leaves, n <= y with phi( x / n, 0 ) = x / n
+static i64 prime_count_ordinary_leaves( const PrimeCount *count )
+{
+	i64 s1 = 0;
+
+	for ( u64 n = 1; n <= count->y; ++n )
+	{
+		i32 value = count->muLpf[ n ];
+
+		if ( value > 0 )
+			s1 += count->x / n;
+		else if ( value < 0 )
+			s1 -= count->x / n;
+	}
+
+	return s1;
+}
+
+static void prime_count_segment_reset( PrimeCountSegment *segment, u64 low, u64 high )
+{
+	segment->low = low;
+	segment->size = high - low;
+	segment->remaining = segment->size;
+
+	u64 words = ( segment->size + 63 ) / 64;
+	u64 blocks = ( segment->size + ( 1ull << PRIME_COUNT_BLOCK_SHIFT ) - 1 ) >> PRIME_COUNT_BLOCK_SHIFT;
+
+	segment->bits.assign( words, UINT64_MAX );
+	if ( segment->size % 64 )
+		segment->bits[ words - 1 ] = ( 1ull << ( segment->size % 64 ) ) - 1;
+
+	segment->blockCounts.assign( blocks, 1u << PRIME_COUNT_BLOCK_SHIFT );
+	segment->blockCounts[ blocks - 1 ] = static_cast<u32>( segment->size - ( ( blocks - 1 ) << PRIME_COUNT_BLOCK_SHIFT ) );
+}
+
+static void prime_count_segment_cross_off( PrimeCountSegment *segment, u64 p )
+{
+	u64 *bits = segment->bits.data();
+	u32 *blockCounts = segment->blockCounts.data();
+	u64 high = segment->low + segment->size;
+
+	u64 n = ( segment->low + p - 1 ) / p * p;
+	u64 step = p;
+
+	// 2 is always crossed off first, so only the odd multiples of the other primes are left
+	if ( p != 2 )
+	{
+		n += ( n & 1 ) ? 0 : p;
+		step = 2 * p;
+	}
+
+	for ( ; n < high; n += step )
+	{
+		u64 index = n - segment->low;
+		u64 bit = 1ull << ( index & 63 );
+
+		if ( bits[ index >> 6 ] & bit )
+		{
+			bits[ index >> 6 ] &= ~bit;
+			--blockCounts[ index >> PRIME_COUNT_BLOCK_SHIFT ];
+			--segment->remaining;
+		}
+	}
+}
+
+inline void prime_count_segment_rewind( PrimeCountSegment *segment )
+{
+	segment->nextBlock = 0;
+	segment->counted = 0;
+}
+
+/// @desc Numbers left in the segment up to low + index, index must not go down until the next rewind
+static u64 prime_count_segment_count( PrimeCountSegment *segment, u64 index )
+{
+	u64 block = index >> PRIME_COUNT_BLOCK_SHIFT;
+
+	for ( ; segment->nextBlock < block; ++segment->nextBlock )
+		segment->counted += segment->blockCounts[ segment->nextBlock ];
+
+	u64 count = segment->counted;
+	u64 word = block << ( PRIME_COUNT_BLOCK_SHIFT - 6 );
+
+	for ( ; word < index >> 6; ++word )
+		count += count_set_bits( segment->bits[ word ] );
+
+	return count + count_set_bits( segment->bits[ word ] & ( UINT64_MAX >> ( 63 - ( index & 63 ) ) ) );
+}
+
+static void prime_count_special_leaves( const PrimeCount *count, PrimeCountInterval *interval )
+{
+	u64 x = count->x;
+	u64 y = count->y;
+	u64 piY = count->pi[ y ];
+	u64 piSqrtY = count->pi[ integer_sqrt( y ) ];
+	const u32 *primes = count->primes.data();
+	const u32 *pi = count->pi.data();
+	const i32 *muLpf = count->muLpf.data();
+
+	PrimeCountSegment segment;
+
+	interval->s2 = 0;
+	interval->phi.assign( piY + 1, 0 );
+	interval->muSum.assign( piY + 1, 0 );
+
+	i64 *phi = interval->phi.data();
+	i64 *muSum = interval->muSum.data();
+
+	for ( u64 low = interval->low; low < interval->high; low += count->segmentSize )
+	{
+		u64 high = ( interval->high - low < count->segmentSize ) ? interval->high : low + count->segmentSize;
+
+		prime_count_segment_reset( &segment, low, high );
+
+		// Leaves n = p * m inside the segment ( low <= x / n < high ) with y < n, m <= y and p below every factor of m
+		u64 b = 1;
+
+		for ( ; b <= piSqrtY; ++b )
+		{
+			u64 p = primes[ b ];
+			u64 minM = ( x / ( p * high ) > y / p ) ? x / ( p * high ) : y / p;
+			u64 maxM = ( x / ( p * low ) < y ) ? x / ( p * low ) : y;
+
+			prime_count_segment_rewind( &segment );
+
+			for ( u64 m = maxM; m > minM; --m )
+			{
+				i32 value = muLpf[ m ];
+
+				if ( value == 0 || p >= static_cast<u64>( value < 0 ? -value : value ) )
+					continue;
+
+				i64 phiXn = phi[ b ] + prime_count_segment_count( &segment, x / ( p * m ) - low );
+
+				if ( value > 0 )
+				{
+					interval->s2 -= phiXn;
+					--muSum[ b ];
+				}
+				else
+				{
+					interval->s2 += phiXn;
+					++muSum[ b ];
+				}
+			}
+
+			phi[ b ] += segment.remaining;
+			prime_count_segment_cross_off( &segment, p );
+		}
+
+		// Above sqrt( y ) the only m left are primes q between p and y. Leaves with x / ( p * q ) <= y are easy
+		// leaves counted from the pi table instead, so only q up to x / ( p * ( y + 1 ) ) are visited here.
+		for ( ; b <= piY; ++b )
+		{
+			u64 p = primes[ b ];
+			u64 maxM = x / ( p * ( low > y ? low : y + 1 ) );
+			u64 l = pi[ maxM < y ? maxM : y ];
+			u64 minM = x / ( p * high );
+
+			if ( minM < y / p )
+				minM = y / p;
+			if ( minM < p )
+				minM = p;
+			if ( minM > y )
+				minM = y;
+
+			// Later segments and larger primes only have fewer leaves
+			if ( p >= primes[ l ] )
+				break;
+
+			prime_count_segment_rewind( &segment );
+
+			for ( u64 minL = pi[ minM ]; l > minL; --l )
+			{
+				interval->s2 += phi[ b ] + prime_count_segment_count( &segment, x / ( p * primes[ l ] ) - low );
+				++muSum[ b ];
+			}
+
+			phi[ b ] += segment.remaining;
+			prime_count_segment_cross_off( &segment, p );
+		}
+	}
+}
+
+// Easy leaves, n = p * q with primes sqrt( y ) < p < q <= y and x / n <= y. Since x / n < p^2 the numbers
+// left are 1 and the primes from p up, so phi( x / n, b - 1 ) = pi( x / n ) - b + 2 (or 1 below p). Runs of q
+// with the same pi( x / n ) are taken at once (Deleglise-Rivat clustered easy leaves).
+static void prime_count_easy_leaves( const PrimeCount *count, u32 thread, u32 threadCount, i64 *s2 )
+{
+	u64 x = count->x;
+	u64 y = count->y;
+	u64 piY = count->pi[ y ];
+	const u32 *primes = count->primes.data();
+	const u32 *pi = count->pi.data();
+	i64 sum = 0;
+
+	for ( u64 b = count->pi[ integer_sqrt( y ) ] + 1 + thread; b <= piY; b += threadCount )
+	{
+		u64 p = primes[ b ];
+		u64 minQ = x / ( p * ( y + 1 ) );
+
+		if ( minQ < y / p )
+			minQ = y / p;
+		if ( minQ < p )
+			minQ = p;
+		if ( minQ >= y )
+			continue;
+
+		for ( u64 l = pi[ minQ ] + 1; l <= piY; )
+		{
+			u64 xn = x / ( p * primes[ l ] );
+
+			if ( xn < p )
+			{
+				sum += piY - l + 1;
+				break;
+			}
+
+			u64 piXn = pi[ xn ];
+			u64 lastQ = x / ( p * primes[ piXn ] );
+			u64 lastL = pi[ lastQ < y ? lastQ : y ];
+
+			sum += static_cast<i64>( lastL - l + 1 ) * ( static_cast<i64>( piXn ) - static_cast<i64>( b ) + 2 );
+			l = lastL + 1;
+		}
+	}
+
+	*s2 = sum;
+}
+
+static i64 prime_count_s2( const PrimeCount *count, u32 threadCount )
+{
+	u64 piY = count->pi[ count->y ];
+	u64 limit = count->z + 1;
+
+	std::vector<i64> phiBefore( piY + 1, 0 );
+	std::vector<PrimeCountInterval> intervals( threadCount );
+	std::vector<std::thread> workers;
+
+	std::vector<i64> easy( threadCount, 0 );
+
+	for ( u32 i = 1; i < threadCount; ++i )
+		workers.emplace_back( prime_count_easy_leaves, count, i, threadCount, &easy[ i ] );
+
+	prime_count_easy_leaves( count, 0, threadCount, &easy[ 0 ] );
+
+	for ( std::thread &worker : workers )
+		worker.join();
+
+	workers.clear();
+
+	i64 s2 = 0;
+	u64 segmentsPerInterval = 1;
+
+	for ( i64 sum : easy )
+		s2 += sum;
+
+	// Leaves thin out quickly as the segments move up, so the intervals grow each round
+	for ( u64 low = 1; low < limit; segmentsPerInterval *= 2 )
+	{
+		u64 span = segmentsPerInterval * count->segmentSize;
+		u32 used = 0;
+
+		for ( ; used < threadCount && low < limit; ++used )
+		{
+			intervals[ used ].low = low;
+			intervals[ used ].high = ( limit - low < span ) ? limit : low + span;
+			low = intervals[ used ].high;
+		}
+
+		for ( u32 i = 1; i < used; ++i )
+			workers.emplace_back( prime_count_special_leaves, count, &intervals[ i ] );
+
+		prime_count_special_leaves( count, &intervals[ 0 ] );
+
+		for ( std::thread &worker : workers )
+			worker.join();
+
+		workers.clear();
+
+		for ( u32 i = 0; i < used; ++i )
+		{
+			const PrimeCountInterval &interval = intervals[ i ];
+
+			s2 += interval.s2;
+
+			for ( u64 b = 1; b <= piY; ++b )
+			{
+				s2 += phiBefore[ b ] * interval.muSum[ b ];
+				phiBefore[ b ] += interval.phi[ b ];
+			}
+		}
+	}
+
+	return s2;
+}
+
+// P2 = sum over primes p in ( y, sqrt( x ) ] of pi( x / p ) - pi( p ) + 1
+static u64 prime_count_p2( const PrimeCount *count, u32 threadCount )
+{
+	u64 x = count->x;
+	u64 y = count->y;
+	u64 sqrtX = integer_sqrt( x );
+
+	if ( y >= sqrtX )
+		return 0;
+
+	u64 primesBelow = 0;						// primes below the current chunk
+	u64 piSum = 0;								// sum of pi( x / p )
+	u64 pCount = 0;								// primes p taken so far
+	std::vector<u64> pValues;
+	std::vector<u64> found;
+	u64 sieved;
+
+	// Chunks arrive in ascending order, the primes p with x / p inside a chunk are visited from the largest down
+	sieve_parallel<WheelSieve>( 2, count->z + 1, DEFAULT_SIEVE_SEGMENT_BYTES, threadCount, &sieved, [&] ( const SieveChunk &chunk )
+		{
+			u64 pLow = ( x / chunk.to > y ) ? x / chunk.to : y;
+			u64 pHigh = ( x / chunk.from < sqrtX ) ? x / chunk.from : sqrtX;
+
+			pValues.clear();
+
+			if ( pLow < pHigh )
+			{
+				WheelSieve sieve;
+				sieve_initialise( &sieve, pLow + 1, pHigh + 1, DEFAULT_SIEVE_SEGMENT_BYTES );
+				found.resize( sieve_segment_capacity( &sieve ) );
+
+				while ( !sieve_finished( &sieve ) )
+				{
+					u64 primeCount = sieve_next_segment( &sieve, found.data() );
+					pValues.insert( pValues.end(), found.data(), found.data() + primeCount );
+				}
+			}
+
+			u64 next = pValues.size();
+			u64 below = primesBelow;
+
+			for ( u64 q : chunk.primes )
+			{
+				for ( ; next > 0 && x / pValues[ next - 1 ] < q; --next )
+					piSum += below;
+
+				++below;
+			}
+
+			for ( ; next > 0; --next )
+				piSum += below;
+
+			pCount += pValues.size();
+			primesBelow = below;
+		} );
+
+	// Less pi( p ) - 1 = b - 1 for each p = primes[ b ], b from a + 1 to a + pCount
+	u64 a = count->pi[ y ];
+
+	return piSum - ( ( a + pCount ) * ( a + pCount - 1 ) - a * ( a - 1 ) ) / 2;
+}
+
+u64 prime_count( u64 x, u32 threadCount )
+{
+	if ( x < PRIME_COUNT_SIEVE_LIMIT )
+		return prime_count_sieve( x );
+
+	if ( threadCount == 0 )
+		threadCount = 1;
+
+	// A larger y moves work from sieving [1, x / y] onto the leaves and the tables
+	f64 logX = log( static_cast<f64>( x ) );
+	f64 alpha = logX * logX / 150.0;
+
+	PrimeCount count;
+	count.x = x;
+	count.y = static_cast<u64>( ( alpha > 1.0 ? alpha : 1.0 ) * static_cast<f64>( integer_cbrt( x ) ) );
+	count.z = x / count.y;
+
+	u64 sqrtZ = integer_sqrt( count.z );
+	count.segmentSize = 1;
+
+	while ( count.segmentSize < sqrtZ )
+		count.segmentSize <<= 1;
+
+	prime_count_tables( &count );
+
+	i64 phi = prime_count_ordinary_leaves( &count ) + prime_count_s2( &count, threadCount );
+	u64 a = count.pi[ count.y ];
+
+	return static_cast<u64>( phi ) + a - 1 - prime_count_p2( &count, threadCount );
+}
+
+u64 prime_count_estimate( u64 low, u64 high )
+{
+	if ( high < 2 || low > high )
+		return 0;
+
+	// pi( x ) < x / ln x * ( 1 + 1.2762 / ln x ) for every x above 1 (Dusart)
+	f64 logHigh = log( static_cast<f64>( high ) );
+	f64 upper = static_cast<f64>( high ) / logHigh * ( 1.0 + 1.2762 / logHigh );
+
+	// The density near x is about 1 / ( ln x - 1 ) and only falls, which bounds narrow ranges far better
+	f64 logLow = log( static_cast<f64>( low > 17 ? low : 17 ) );
+	f64 interval = static_cast<f64>( high - low + 1 ) / ( logLow - 1.0 );
+
+	return static_cast<u64>( interval < upper ? interval : upper ) + 1;
+}
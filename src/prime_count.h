@@ -0,0 +1,55 @@
+#pragma once
+
+// Prime counting without generating the primes (Lagarias-Miller-Odlyzko).
+// With y at least cbrt( x ) and a = pi( y ), every number up to x without a prime factor up to y is 1, a prime
+// above y or a product of two of them, so pi( x ) = phi( x, a ) + a - 1 - P2( x, a ).
+// phi( x, a ) splits into ordinary leaves summed directly and special leaves counted while sieving [1, x / y]
+// (or straight from the pi table up to y for the easy leaves),
+// P2 counts the primes up to x / p for each prime p in ( y, sqrt( x ) ] by sieving the same range.
+#define PRIME_COUNT_MAX							( 1000000000000000000ull )
+#define PRIME_COUNT_SIEVE_LIMIT					( 10000000ull )
+#define PRIME_COUNT_BLOCK_SHIFT					( 10 )
+
+struct PrimeCount
+{
+	u64 x;
+	u64 y;									// leaves up to y
+	u64 z;									// sieving limit x / y
+	u64 segmentSize;						// integers per special leaf segment
+	std::vector<u32> oddPrimes;				// odd primes up to max( y, sqrt( z ) ), shared by the sieves
+	std::vector<u32> primes;				// primes[ b ] is the b-th prime (primes[ 0 ] unused) up to y
+	std::vector<u32> pi;					// pi( n ) for n <= y
+	std::vector<i32> muLpf;					// mu( n ) * least prime factor of n for n <= y, 0 when not square free
+};
+
+// Special leaf sieve segment, one bit per number (set while not crossed off) plus a count for every block of
+// 1 << PRIME_COUNT_BLOCK_SHIFT numbers. The leaves of one prime are visited with x / n going up, so a cursor
+// moves forward through the block counts and only the bits of the last block are counted.
+struct PrimeCountSegment
+{
+	u64 low;
+	u64 size;
+	u64 remaining;							// numbers not crossed off
+	std::vector<u64> bits;
+	std::vector<u32> blockCounts;
+	u64 nextBlock;							// first block past the cursor
+	u64 counted;							// numbers left in the blocks before nextBlock
+};
+
+// Special leaves of one interval of [1, z], counted as if phi was 0 at its start. The calling thread adds
+// phi( interval start - 1, b - 1 ) * muSum[ b ] once the intervals before it are done.
+struct PrimeCountInterval
+{
+	u64 low;
+	u64 high;
+	i64 s2;
+	std::vector<i64> phi;					// numbers in the interval left after crossing off the first b - 1 primes
+	std::vector<i64> muSum;					// sum of -mu( m ) over the special leaves of primes[ b ]
+};
+
+/// @desc Counts the primes up to x (at most PRIME_COUNT_MAX) across threadCount workers
+/// @return pi( x )
+u64 prime_count( u64 x, u32 threadCount );
+
+/// @desc A generous estimate of the primes in [low, high] without any sieving, for sizing files ahead of generation
+[[nodiscard]] u64 prime_count_estimate( u64 low, u64 high );
@@ -0,0 +1,837 @@
+static void prime_file_seal_header( PrimeFileHeader *header )
+{
+	header->headerChecksum = crc32c( 0, header, offsetof( PrimeFileHeader, headerChecksum ) );
+}
+
+static u64 prime_file_index_bytes( const PrimeFileHeader *header )
+{
+	return ( header->format == PRIME_FILE_FORMAT_GAP ) ? header->dataBytes / PRIME_GAP_BLOCK_BYTES * sizeof( PrimeGapBlock ) : 0;
+}
+
+static u64 prime_file_checksum_count( const PrimeFileHeader *header )
+{
+	return header->dataBytes / header->checksumBlockBytes + ( header->dataBytes % header->checksumBlockBytes != 0 );
+}
+
+[[nodiscard]] const char *prime_file_header_error( const PrimeFileHeader *header, u64 fileSize )
+{
+	if ( fileSize < sizeof( PrimeFileHeader ) || header->magic != PRIME_FILE_MAGIC )
+		return "not a prime file";
+
+	if ( header->endianTag != PRIME_FILE_ENDIAN_TAG )
+		return "written with the other byte order";
+
+	if ( header->version != PRIME_FILE_VERSION )
+		return "written by another version";
+
+	if ( header->headerChecksum != crc32c( 0, header, offsetof( PrimeFileHeader, headerChecksum ) ) )
+		return "the header checksum does not match";
+
+	if ( header->format >= PRIME_FILE_FORMAT_COUNT || header->checksumBlockBytes == 0 )
+		return "unknown format";
+
+	if ( header->dataBytes > fileSize - sizeof( PrimeFileHeader ) )
+		return "shorter than its header says";
+
+	switch ( header->format )
+	{
+	case PRIME_FILE_FORMAT_RAW:
+		if ( header->dataBytes % sizeof( u64 ) != 0 || header->dataBytes / sizeof( u64 ) != header->count )
+			return "the count does not match the data";
+		break;
+
+	case PRIME_FILE_FORMAT_GAP:
+		if ( header->dataBytes % PRIME_GAP_BLOCK_BYTES != 0 )
+			return "part of a gap block";
+		break;
+
+	case PRIME_FILE_FORMAT_BITMAP:
+		if ( header->low != 0 || header->dataBytes != ( header->limit ? ( header->limit - 1 ) / 30 + 1 : 0 ) )
+			return "the limit does not match the data";
+		break;
+	}
+
+	if ( header->trailerOffset )
+	{
+		u64 trailerBytes = prime_file_index_bytes( header ) + prime_file_checksum_count( header ) * sizeof( u32 );
+
+		if ( header->trailerOffset != sizeof( PrimeFileHeader ) + header->dataBytes || fileSize - header->trailerOffset < trailerBytes )
+			return "the trailer is missing";
+	}
+
+	return nullptr;
+}
+
+static bool prime_file_write_header( u32 file, PrimeFileHeader *header )
+{
+	prime_file_seal_header( header );
+
+	platform_seek_in_file( file, FILE_SEEK_START, 0 );
+	bool written = platform_write_to_file( file, header, sizeof( PrimeFileHeader ) ) == sizeof( PrimeFileHeader );
+	platform_flush_file( file );
+	platform_seek_in_file( file, FILE_SEEK_END, 0 );
+
+	return written;
+}
+
+/// @desc Writes data through the writer, adding it to the checksums on the way
+static bool prime_file_write_data( PrimeFileAppend *append, const void *data, u64 size )
+{
+	const u8 *bytes = static_cast<const u8 *>( data );
+
+	for ( u64 remaining = size; remaining > 0; )
+	{
+		u64 offset = append->dataBytes % PRIME_FILE_CHECKSUM_BLOCK;
+
+		if ( offset == 0 )
+			append->checksums.push_back( 0 );
+
+		u64 run = ( remaining < PRIME_FILE_CHECKSUM_BLOCK - offset ) ? remaining : PRIME_FILE_CHECKSUM_BLOCK - offset;
+
+		append->checksums.back() = crc32c( append->checksums.back(), bytes, run );
+		append->dataBytes += run;
+		bytes += run;
+		remaining -= run;
+	}
+
+	return platform_writer_write( &append->writer, data, size );
+}
+
+static void prime_file_append_initialise( PrimeFileAppend *append, u32 file, u64 high, u64 blockSize )
+{
+	append->pending = 0;
+	append->previous = 0;
+	append->blockOpen = false;
+	append->block.resize( append->header.format == PRIME_FILE_FORMAT_GAP ? PRIME_GAP_BLOCK_BYTES : 0 );
+
+	platform_writer_open( &append->writer, file, blockSize );
+
+	u64 expectedBytes = 0;
+
+	if ( append->header.format == PRIME_FILE_FORMAT_BITMAP )
+	{
+		expectedBytes = ( high > 0 ) ? ( high - 1 ) / 30 + 1 - append->dataBytes : 0;
+	}
+	else if ( high > append->limit )
+	{
+		u64 expectedPrimes = prime_count_estimate( append->limit, high - 1 );
+
+		// About a byte per prime in the gap format, the block headers and the index add under 2% to that
+		expectedBytes = ( append->header.format == PRIME_FILE_FORMAT_GAP ) ? expectedPrimes + expectedPrimes / 64 : expectedPrimes * sizeof( u64 );
+	}
+
+	// Reserving the space up front stops the file system fragmenting the file as it grows
+	platform_preallocate_file( file, platform_get_file_size( file ) + expectedBytes );
+}
+
+void prime_file_append_begin( PrimeFileAppend *append, u32 file, PrimeFileFormat format, u64 low, u64 high, u64 blockSize )
+{
+	append->header =
+	{
+		.magic = PRIME_FILE_MAGIC,
+		.version = PRIME_FILE_VERSION,
+		.endianTag = PRIME_FILE_ENDIAN_TAG,
+		.format = format,
+		.checksumBlockBytes = PRIME_FILE_CHECKSUM_BLOCK,
+		.low = low,
+		.limit = low,
+		.count = 0,
+		.dataBytes = 0,
+		.trailerOffset = 0,
+		.indexChecksum = 0,
+		.headerChecksum = 0,
+	};
+
+	prime_file_seal_header( &append->header );
+	platform_write_to_file( file, &append->header, sizeof( PrimeFileHeader ) );
+
+	append->dataBytes = 0;
+	append->limit = low;
+	append->checksums.clear();
+	append->index.clear();
+
+	prime_file_append_initialise( append, file, high, blockSize );
+}
+
+bool prime_file_append_resume( PrimeFileAppend *append, PrimeFileReader *reader, u64 high, u64 blockSize )
+{
+	u32 file = reader->fileID;
+	PrimeFileHeader header = reader->header;
+	u64 fileSize = platform_get_file_size( file );
+	u64 end = sizeof( PrimeFileHeader ) + header.dataBytes;
+
+	append->checksums.assign( prime_file_checksum_count( &header ), 0 );
+
+	// The checksums so far come from the trailer, or from the data itself when the writer never got to close the file
+	bool checksumsRead = false;
+
+	if ( header.trailerOffset )
+	{
+		u64 checksumBytes = append->checksums.size() * sizeof( u32 );
+
+		platform_seek_in_file( file, FILE_SEEK_START, header.trailerOffset + prime_file_index_bytes( &header ) );
+		checksumsRead = platform_read_from_file( file, append->checksums.data(), checksumBytes ) == checksumBytes;
+	}
+
+	if ( !checksumsRead )
+	{
+		show_log_info( "Rebuilding the checksums of the data written so far." );
+
+		std::vector<u8> slice( PRIME_FILE_CHECKSUM_BLOCK );
+
+		platform_seek_in_file( file, FILE_SEEK_START, sizeof( PrimeFileHeader ) );
+
+		for ( u64 i = 0; i < append->checksums.size(); ++i )
+		{
+			u64 bytes = ( header.dataBytes - i * PRIME_FILE_CHECKSUM_BLOCK < PRIME_FILE_CHECKSUM_BLOCK ) ? header.dataBytes - i * PRIME_FILE_CHECKSUM_BLOCK : PRIME_FILE_CHECKSUM_BLOCK;
+
+			if ( platform_read_from_file( file, slice.data(), bytes ) != bytes )
+				return false;
+
+			append->checksums[ i ] = crc32c( 0, slice.data(), bytes );
+		}
+	}
+
+	// Anything else past the data was written after the last checkpoint of an interrupted run. The header stops
+	// pointing at the trailer before it is cut off.
+	if ( fileSize > end )
+	{
+		if ( !header.trailerOffset )
+			show_log_info( "Discarding %llu bytes past the last checkpoint.", fileSize - end );
+
+		header.trailerOffset = 0;
+
+		if ( !prime_file_write_header( file, &header ) || !platform_set_file_size( file, end ) )
+			return false;
+	}
+
+	platform_seek_in_file( file, FILE_SEEK_END, 0 );
+
+	append->header = header;
+	append->dataBytes = header.dataBytes;
+	append->limit = header.limit;
+	append->index = reader->index;
+
+	prime_file_append_initialise( append, file, high, blockSize );
+
+	return true;
+}
+
+static void prime_file_gap_close_block( PrimeFileAppend *append )
+{
+	if ( !append->blockOpen )
+		return;
+
+	const PrimeGapBlock &header = append->index.back();
+	u8 *block = append->block.data();
+
+	memcpy( block, &header, sizeof( header ) );
+	memset( block + sizeof( header ) + header.bytes, 0, PRIME_GAP_BLOCK_BYTES - sizeof( header ) - header.bytes );
+
+	prime_file_write_data( append, block, PRIME_GAP_BLOCK_BYTES );
+	append->blockOpen = false;
+}
+
+static void prime_file_gap_append( PrimeFileAppend *append, const u64 *primes, u64 count )
+{
+	for ( u64 i = 0; i < count; ++i )
+	{
+		u64 prime = primes[ i ];
+
+		if ( append->blockOpen )
+		{
+			PrimeGapBlock &header = append->index.back();
+
+			// Every gap is even apart from 2 to 3, which gets the otherwise unused 0
+			u64 halfGap = ( prime - append->previous ) / 2;
+			u8 encoded[ 10 ];
+			u32 length = 0;
+
+			do
+			{
+				encoded[ length ] = static_cast<u8>( halfGap & 0x7F );
+				halfGap >>= 7;
+
+				if ( halfGap )
+					encoded[ length ] |= 0x80;
+
+				++length;
+			} while ( halfGap );
+
+			if ( sizeof( header ) + header.bytes + length <= PRIME_GAP_BLOCK_BYTES )
+			{
+				memcpy( append->block.data() + sizeof( header ) + header.bytes, encoded, length );
+				header.bytes += length;
+				++header.count;
+				append->previous = prime;
+				++append->pending;
+				append->limit = prime + 1;
+				continue;
+			}
+
+			prime_file_gap_close_block( append );
+
+			// Checkpoints only fall between whole blocks, so where the blocks end depends on the primes alone and
+			// not on how they were handed over
+			if ( append->pending >= PRIME_FILE_CHECKPOINT_PRIMES )
+				prime_file_commit( append );
+		}
+
+		PrimeGapBlock header = { .first = prime, .ordinal = append->header.count + append->pending, .count = 1, .bytes = 0 };
+		append->index.push_back( header );
+		append->blockOpen = true;
+		append->previous = prime;
+		++append->pending;
+		append->limit = prime + 1;
+	}
+}
+
+void prime_file_append( PrimeFileAppend *append, const u64 *primes, u64 count )
+{
+	if ( count == 0 )
+		return;
+
+	// The gap format counts the primes and commits as it fills its blocks
+	if ( append->header.format == PRIME_FILE_FORMAT_GAP )
+	{
+		prime_file_gap_append( append, primes, count );
+		return;
+	}
+
+	prime_file_write_data( append, primes, count * sizeof( u64 ) );
+
+	append->pending += count;
+	append->limit = primes[ count - 1 ] + 1;
+
+	if ( append->pending >= PRIME_FILE_CHECKPOINT_PRIMES )
+		prime_file_commit( append );
+}
+
+void prime_file_append_bits( PrimeFileAppend *append, const u8 *bits, u64 size, u64 count )
+{
+	if ( size > 0 )
+		prime_file_write_data( append, bits, size );
+
+	append->pending += count;
+	append->limit = append->dataBytes * WheelSieve::INTEGERS_PER_BYTE;
+
+	if ( append->pending >= PRIME_FILE_CHECKPOINT_PRIMES )
+		prime_file_commit( append );
+}
+
+bool prime_file_commit( PrimeFileAppend *append )
+{
+	// A gap block is only ever written whole, the next primes start a new one. Only the end of the file commits with
+	// a block still open, every other checkpoint comes as a block fills.
+	if ( append->header.format == PRIME_FILE_FORMAT_GAP )
+		prime_file_gap_close_block( append );
+
+	// The data must reach the disk before the header that covers it
+	if ( !platform_writer_flush( &append->writer ) || !platform_flush_file( append->writer.fileID ) )
+		return false;
+
+	PrimeFileHeader header = append->header;
+	header.count += append->pending;
+	header.dataBytes = append->dataBytes;
+	header.limit = append->limit;
+	header.trailerOffset = 0;
+
+	if ( !prime_file_write_header( append->writer.fileID, &header ) )
+		return false;
+
+	append->header = header;
+	append->pending = 0;
+
+	return true;
+}
+
+bool prime_file_append_end( PrimeFileAppend *append, u64 limit )
+{
+	// Nothing was found between the last prime written and limit, and the last bitmap byte can run past it
+	if ( limit > append->limit || append->header.format == PRIME_FILE_FORMAT_BITMAP )
+		append->limit = limit;
+
+	bool committed = prime_file_commit( append );
+
+	// The trailer goes after the data, the header only points at it once it is all there
+	if ( committed )
+	{
+		PrimeFileHeader header = append->header;
+		header.trailerOffset = sizeof( PrimeFileHeader ) + header.dataBytes;
+		header.indexChecksum = crc32c( 0, append->index.data(), append->index.size() * sizeof( PrimeGapBlock ) );
+
+		if ( header.format == PRIME_FILE_FORMAT_GAP )
+			committed = platform_writer_write( &append->writer, append->index.data(), append->index.size() * sizeof( PrimeGapBlock ) );
+
+		committed = committed && platform_writer_write( &append->writer, append->checksums.data(), append->checksums.size() * sizeof( u32 ) ) &&
+			platform_writer_flush( &append->writer ) && platform_flush_file( append->writer.fileID ) &&
+			prime_file_write_header( append->writer.fileID, &header );
+
+		if ( committed )
+			append->header = header;
+	}
+
+	return platform_writer_close( &append->writer ) && committed;
+}
+
+void prime_file_append_cancel( PrimeFileAppend *append )
+{
+	(void)platform_writer_close( &append->writer );
+}
+
+bool prime_file_read_begin( PrimeFileReader *reader, u32 file )
+{
+	reader->fileID = file;
+	reader->position = 0;
+	reader->index.clear();
+	reader->blockIndex = 0;
+
+	u64 fileSize = platform_get_file_size( file );
+	PrimeFileHeader &header = reader->header;
+
+	platform_seek_in_file( file, FILE_SEEK_START, 0 );
+
+	if ( platform_read_from_file( file, &header, sizeof( header ) ) != sizeof( header ) )
+		header = {};
+
+	if ( const char *error = prime_file_header_error( &header, fileSize ) )
+	{
+		show_log_warning( "Prime file rejected: %s.", error );
+		return false;
+	}
+
+	if ( header.format == PRIME_FILE_FORMAT_BITMAP )
+	{
+		show_log_warning( "Prime file rejected: it is a bitmap, not a list of primes." );
+		return false;
+	}
+
+	reader->format = header.format;
+	reader->count = header.count;
+
+	if ( reader->format == PRIME_FILE_FORMAT_RAW )
+		return prime_file_read_seek( reader, 0 );
+
+	u64 blockCount = header.dataBytes / PRIME_GAP_BLOCK_BYTES;
+
+	reader->index.resize( blockCount );
+	reader->block.resize( PRIME_GAP_BLOCK_BYTES );
+
+	bool indexRead = false;
+
+	if ( header.trailerOffset )
+	{
+		platform_seek_in_file( file, FILE_SEEK_START, header.trailerOffset );
+
+		indexRead = platform_read_from_file( file, reader->index.data(), blockCount * sizeof( PrimeGapBlock ) ) == blockCount * sizeof( PrimeGapBlock ) &&
+			crc32c( 0, reader->index.data(), blockCount * sizeof( PrimeGapBlock ) ) == header.indexChecksum;
+	}
+
+	if ( !indexRead )
+	{
+		for ( u64 i = 0; i < blockCount; ++i )
+		{
+			platform_seek_in_file( file, FILE_SEEK_START, sizeof( PrimeFileHeader ) + i * PRIME_GAP_BLOCK_BYTES );
+
+			if ( platform_read_from_file( file, &reader->index[ i ], sizeof( PrimeGapBlock ) ) != sizeof( PrimeGapBlock ) )
+				return false;
+		}
+	}
+
+	// The blocks have to follow on from each other and add up to the count
+	u64 ordinal = 0;
+
+	for ( const PrimeGapBlock &block : reader->index )
+	{
+		if ( block.ordinal != ordinal || block.count == 0 || block.bytes > PRIME_GAP_BLOCK_BYTES - sizeof( PrimeGapBlock ) )
+			return false;
+
+		ordinal += block.count;
+	}
+
+	if ( ordinal != reader->count )
+		return false;
+
+	reader->blockIndex = reader->index.size();
+
+	return prime_file_read_seek( reader, 0 );
+}
+
+static bool prime_file_load_block( PrimeFileReader *reader, u64 blockIndex )
+{
+	platform_seek_in_file( reader->fileID, FILE_SEEK_START, sizeof( PrimeFileHeader ) + blockIndex * PRIME_GAP_BLOCK_BYTES );
+
+	if ( platform_read_from_file( reader->fileID, reader->block.data(), PRIME_GAP_BLOCK_BYTES ) != PRIME_GAP_BLOCK_BYTES )
+	{
+		reader->blockIndex = reader->index.size();
+		return false;
+	}
+
+	reader->blockIndex = blockIndex;
+	reader->blockOffset = sizeof( PrimeGapBlock );
+	reader->next = reader->index[ blockIndex ].first;
+
+	return true;
+}
+
+/// @desc Decodes the gap to the prime after next in the loaded block
+static bool prime_file_gap_step( PrimeFileReader *reader )
+{
+	const u8 *block = reader->block.data();
+	u64 end = sizeof( PrimeGapBlock ) + reader->index[ reader->blockIndex ].bytes;
+	u64 halfGap = 0;
+
+	for ( u32 shift = 0; reader->blockOffset < end && shift < 64; shift += 7 )
+	{
+		u8 byte = block[ reader->blockOffset++ ];
+		halfGap |= static_cast<u64>( byte & 0x7F ) << shift;
+
+		if ( !( byte & 0x80 ) )
+		{
+			reader->next += halfGap ? 2 * halfGap : 1;
+			return true;
+		}
+	}
+
+	// Nothing sensible follows a broken gap
+	reader->blockIndex = reader->index.size();
+
+	return false;
+}
+
+bool prime_file_read_seek( PrimeFileReader *reader, u64 ordinal )
+{
+	if ( ordinal > reader->count )
+		return false;
+
+	reader->position = ordinal;
+
+	if ( reader->format == PRIME_FILE_FORMAT_RAW )
+		return platform_seek_in_file( reader->fileID, FILE_SEEK_START, sizeof( PrimeFileHeader ) + sizeof( u64 ) * ordinal );
+
+	if ( ordinal == reader->count )
+	{
+		reader->blockIndex = reader->index.size();
+		return true;
+	}
+
+	// The last block starting at or before ordinal holds it
+	auto found = std::upper_bound( reader->index.begin(), reader->index.end(), ordinal, [] ( u64 value, const PrimeGapBlock &block ) { return value < block.ordinal; } );
+	u64 blockIndex = static_cast<u64>( found - reader->index.begin() ) - 1;
+
+	if ( !prime_file_load_block( reader, blockIndex ) )
+		return false;
+
+	for ( u64 skip = ordinal - reader->index[ blockIndex ].ordinal; skip > 0; --skip )
+		if ( !prime_file_gap_step( reader ) )
+			return false;
+
+	return true;
+}
+
+u64 prime_file_read( PrimeFileReader *reader, u64 *primes, u64 count )
+{
+	if ( count > reader->count - reader->position )
+		count = reader->count - reader->position;
+
+	if ( reader->format == PRIME_FILE_FORMAT_RAW )
+	{
+		u64 read = platform_read_from_file( reader->fileID, primes, count * sizeof( u64 ) ) / sizeof( u64 );
+		reader->position += read;
+		return read;
+	}
+
+	u64 read = 0;
+
+	while ( read < count && reader->blockIndex < reader->index.size() )
+	{
+		const PrimeGapBlock &block = reader->index[ reader->blockIndex ];
+
+		primes[ read++ ] = reader->next;
+		++reader->position;
+
+		if ( reader->position < block.ordinal + block.count )
+		{
+			if ( !prime_file_gap_step( reader ) )
+				break;
+		}
+		else if ( reader->position < reader->count )
+		{
+			if ( !prime_file_load_block( reader, reader->blockIndex + 1 ) )
+				break;
+		}
+		else
+		{
+			reader->blockIndex = reader->index.size();
+		}
+	}
+
+	return read;
+}
+
+struct PrimeFileVerifyResult
+{
+	u64 mismatches;
+	u64 firstMismatch;						// data offset of the first bad block, ~0 for none
+};
+
+static void prime_file_verify_blocks( const PrimeFileHeader *header, const u8 *data, const u8 *checksums, u64 first, u64 end, PrimeFileVerifyResult *result )
+{
+	*result = { .mismatches = 0, .firstMismatch = ~0ull };
+
+	for ( u64 i = first; i < end; ++i )
+	{
+		u64 offset = i * header->checksumBlockBytes;
+		u64 bytes = ( header->dataBytes - offset < header->checksumBlockBytes ) ? header->dataBytes - offset : header->checksumBlockBytes;
+
+		// The trailer is only 4 byte aligned after a gap index
+		u32 expected;
+		memcpy( &expected, checksums + i * sizeof( u32 ), sizeof( u32 ) );
+
+		if ( crc32c( 0, data + offset, bytes ) != expected )
+		{
+			if ( result->mismatches++ == 0 )
+				result->firstMismatch = offset;
+		}
+	}
+}
+
+bool prime_file_verify( const char *path, u32 threadCount )
+{
+	MappedFile mapped;
+
+	if ( !platform_map_file( path, FILE_MAP_HINT_SEQUENTIAL, &mapped ) )
+	{
+		show_log_warning( "Unable to open %s.", path );
+		return false;
+	}
+
+	PrimeFileHeader header = {};
+
+	if ( mapped.size >= sizeof( header ) )
+		memcpy( &header, mapped.data, sizeof( header ) );
+
+	if ( const char *error = prime_file_header_error( &header, mapped.size ) )
+	{
+		show_log_warning( "%s rejected: %s.", path, error );
+		platform_unmap_file( &mapped );
+		return false;
+	}
+
+	if ( !header.trailerOffset )
+	{
+		show_log_warning( "%s has no checksums, the run writing it was interrupted (extend it to finish it).", path );
+		platform_unmap_file( &mapped );
+		return false;
+	}
+
+	const u8 *data = mapped.data + sizeof( PrimeFileHeader );
+	const u8 *index = mapped.data + header.trailerOffset;
+	u64 indexBytes = prime_file_index_bytes( &header );
+	u64 blockCount = prime_file_checksum_count( &header );
+
+	if ( threadCount > blockCount )
+		threadCount = blockCount ? static_cast<u32>( blockCount ) : 1;
+
+	// Each thread takes a run of blocks, the checksums are independent of each other
+	std::vector<PrimeFileVerifyResult> results( threadCount );
+	std::vector<std::thread> workers;
+	u64 perThread = blockCount / threadCount;
+	u64 extra = blockCount % threadCount;
+	u64 first = 0;
+
+	for ( u32 i = 0; i < threadCount; ++i )
+	{
+		u64 end = first + perThread + ( i < extra );
+
+		if ( i + 1 < threadCount )
+			workers.emplace_back( prime_file_verify_blocks, &header, data, index + indexBytes, first, end, &results[ i ] );
+		else
+			prime_file_verify_blocks( &header, data, index + indexBytes, first, end, &results[ i ] );
+
+		first = end;
+	}
+
+	for ( std::thread &worker : workers )
+		worker.join();
+
+	u64 mismatches = 0;
+	u64 firstMismatch = ~0ull;
+
+	for ( const PrimeFileVerifyResult &result : results )
+	{
+		mismatches += result.mismatches;
+
+		if ( result.firstMismatch < firstMismatch )
+			firstMismatch = result.firstMismatch;
+	}
+
+	bool indexValid = crc32c( 0, index, indexBytes ) == header.indexChecksum;
+
+	platform_unmap_file( &mapped );
+
+	if ( mismatches )
+		show_log_warning( "%s: %llu of %llu blocks do not match their checksums, the first at data offset %llu.", path, mismatches, blockCount, firstMismatch );
+
+	if ( !indexValid )
+		show_log_warning( "%s: the gap index does not match its checksum.", path );
+
+	if ( mismatches || !indexValid )
+		return false;
+
+	show_log_info( "%s: %llu bytes of data in %llu blocks match their checksums (%llu primes below %llu).", path, header.dataBytes, blockCount, header.count, header.limit );
+
+	return true;
+}
+
+bool prime_bitmap_load( PrimeBitmap *bitmap, const char *path )
+{
+	if ( !platform_map_file( path, FILE_MAP_HINT_RANDOM, &bitmap->mapping ) )
+		return false;
+
+	PrimeFileHeader header = {};
+	u64 fileSize = bitmap->mapping.size;
+
+	if ( fileSize >= sizeof( header ) )
+		memcpy( &header, bitmap->mapping.data, sizeof( header ) );
+
+	const char *error = prime_file_header_error( &header, fileSize );
+
+	if ( !error && header.format != PRIME_FILE_FORMAT_BITMAP )
+		error = "it is not a bitmap";
+
+	// A limit of 0 is a file the generator never got going on
+	if ( !error && header.limit == 0 )
+		error = "it is empty";
+
+	if ( error )
+	{
+		show_log_warning( "Prime bitmap file rejected: %s. Regenerate.", error );
+		platform_unmap_file( &bitmap->mapping );
+		return false;
+	}
+
+	bitmap->bits = bitmap->mapping.data + sizeof( header );
+	bitmap->size = header.dataBytes;
+	bitmap->count = header.count;
+	bitmap->limit = header.limit;
+
+	verbose_log_message( "Mapped the primes below %llu as a bitmap.", bitmap->limit );
+
+	return true;
+}
+
+void prime_bitmap_free( PrimeBitmap *bitmap )
+{
+	platform_unmap_file( &bitmap->mapping );
+	bitmap->bits = nullptr;
+	bitmap->size = 0;
+}
+
+[[nodiscard]] bool prime_bitmap_is_prime( const PrimeBitmap *bitmap, u64 value )
+{
+	if ( value < 6 )
+		return value == 2 || value == 3 || value == 5;
+
+	u8 bit = WHEEL.index[ value % 30 ];
+
+	return bit != 0xFF && ( bitmap->bits[ value / 30 ] & BIT( bit ) );
+}
+
+/// @desc Bits of the wheel residues above residue
+static u8 prime_bitmap_residues_above( u64 residue )
+{
+	u8 mask = 0;
+
+	for ( u8 i = 0; i < 8; ++i )
+		if ( WHEEL_OFFSETS[ i ] > residue )
+			mask |= BIT( i );
+
+	return mask;
+}
+
+[[nodiscard]] u64 prime_bitmap_next( const PrimeBitmap *bitmap, u64 value )
+{
+	for ( u64 p : { 2, 3, 5 } )
+		if ( value < p )
+			return p < bitmap->limit ? p : 0;
+
+	const u8 *bits = bitmap->bits;
+	u64 size = bitmap->size;
+	u64 byte = value / 30;
+
+	if ( byte >= size )
+		return 0;
+
+	u8 found = bits[ byte ] & prime_bitmap_residues_above( value % 30 );
+
+	if ( found )
+		return 30 * byte + WHEEL_OFFSETS[ count_trailing_zeros( found ) ];
+
+	// Bits past the limit are never set, so the first one found is below it
+	for ( ++byte; byte + sizeof( u64 ) <= size; byte += sizeof( u64 ) )
+	{
+		u64 word;
+		memcpy( &word, bits + byte, sizeof( u64 ) );
+
+		if ( word )
+		{
+			u32 bit = count_trailing_zeros( word );
+			return 30 * ( byte + ( bit >> 3 ) ) + WHEEL_OFFSETS[ bit & 7 ];
+		}
+	}
+
+	for ( ; byte < size; ++byte )
+		if ( bits[ byte ] )
+			return 30 * byte + WHEEL_OFFSETS[ count_trailing_zeros( bits[ byte ] ) ];
+
+	return 0;
+}
+
+[[nodiscard]] u64 prime_bitmap_previous( const PrimeBitmap *bitmap, u64 value )
+{
+	if ( value > bitmap->limit )
+		value = bitmap->limit;
+
+	// 7 is the first prime with a bit
+	if ( value <= 7 )
+	{
+		for ( u64 p : { 5, 3, 2 } )
+			if ( p < value )
+				return p;
+
+		return 0;
+	}
+
+	const u8 *bits = bitmap->bits;
+	u64 last = value - 1;
+	u64 byte = last / 30;
+	u8 found = bits[ byte ] & static_cast<u8>( ~prime_bitmap_residues_above( last % 30 ) );
+
+	if ( found )
+		return 30 * byte + WHEEL_OFFSETS[ 63 - count_leading_zeros( found ) ];
+
+	while ( byte >= sizeof( u64 ) )
+	{
+		byte -= sizeof( u64 );
+
+		u64 word;
+		memcpy( &word, bits + byte, sizeof( u64 ) );
+
+		if ( word )
+		{
+			u32 bit = 63 - count_leading_zeros( word );
+			return 30 * ( byte + ( bit >> 3 ) ) + WHEEL_OFFSETS[ bit & 7 ];
+		}
+	}
+
+	while ( byte > 0 )
+	{
+		--byte;
+
+		if ( bits[ byte ] )
+			return 30 * byte + WHEEL_OFFSETS[ 63 - count_leading_zeros( bits[ byte ] ) ];
+	}
+
+	return 5;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+// Every prime file is a PrimeFileHeader, then its data, then once the file is closed the trailer at trailerOffset.
+//	PRIME_FILE_FORMAT_RAW		: count u64 primes in ascending order
+//	PRIME_FILE_FORMAT_GAP		: blocks of PRIME_GAP_BLOCK_BYTES, the trailer starts with a PrimeGapBlock index of them
+//	PRIME_FILE_FORMAT_BITMAP	: a byte per 30 integers from 0, bit i set when 30 * byte + WHEEL_OFFSETS[ i ] is prime
+// The trailer ends with a CRC32C of each checksumBlockBytes of the data.
+// PRIME_NUMBER_FILE is raw or gap, PRIME_RANGE_FILE is raw and PRIME_BITMAP_FILE is a bitmap. A PRIME_TUPLE_FILE is
+// raw or gap and holds the first prime of each tuple.
+using PrimeFileFormat = u32;
+enum PRIME_FILE_FORMAT : PrimeFileFormat
+{
+	PRIME_FILE_FORMAT_RAW,					// u64 per prime
+	PRIME_FILE_FORMAT_GAP,					// about a byte per prime
+	PRIME_FILE_FORMAT_BITMAP,				// a bit per integer coprime to 30
+	PRIME_FILE_FORMAT_COUNT,
+};
+
+struct PrimeFileHeader
+{
+	u64 magic;								// PRIME_FILE_MAGIC
+	u32 version;							// PRIME_FILE_VERSION
+	u32 endianTag;							// PRIME_FILE_ENDIAN_TAG in the byte order of the writer
+	PrimeFileFormat format;
+	u32 checksumBlockBytes;					// data bytes covered by each checksum
+	u64 low;								// first integer sieved
+	u64 limit;								// every prime in [low, limit) is in the committed data
+	u64 count;								// primes in the committed data
+	u64 dataBytes;							// committed data, from sizeof( PrimeFileHeader )
+	u64 trailerOffset;						// 0 until the file is closed
+	u32 indexChecksum;						// CRC32C of the gap index
+	u32 headerChecksum;						// CRC32C of the header up to here
+};
+
+// Each PRIME_GAP_BLOCK_BYTES block is this header then the gaps after first, each half gap as a little endian
+// base 128 varint (a half gap of 0 is the step from 2 to 3). The rest of the block is padding.
+struct PrimeGapBlock
+{
+	u64 first;								// first prime of the block
+	u64 ordinal;							// primes before first in the whole file
+	u32 count;								// primes in the block, first included
+	u32 bytes;								// bytes of gaps after the header
+};
+
+/// @desc Checks everything the header says about itself and the size of the file without reading any data
+/// @return nullptr when the header can be trusted, otherwise what is wrong with it
+[[nodiscard]] const char *prime_file_header_error( const PrimeFileHeader *header, u64 fileSize );
+
+// Appends to a new or resumed prime file. The header only moves forward once the data it covers is on disk, so an
+// interrupted run leaves a valid file behind (anything past the committed data is ignored). The checksums of the
+// data are worked out as it goes and written in the trailer when the file is closed.
+struct PrimeFileAppend
+{
+	FileWriter writer;
+	PrimeFileHeader header;					// as last committed
+	u64 pending;							// primes written since the last commit
+	u64 dataBytes;							// data written, committed or not
+	u64 limit;								// every prime below limit has been written
+	std::vector<u32> checksums;				// one per PRIME_FILE_CHECKSUM_BLOCK of data, the last one still growing
+
+	// Gap format
+	std::vector<u8> block;					// block being encoded
+	u64 previous;							// last prime in the open block
+	bool blockOpen;							// index.back() is still being filled
+	std::vector<PrimeGapBlock> index;		// headers of every block written, committed or not
+};
+
+/// @desc Starts a prime file of the primes in [low, high) in the empty file, writing its header and reserving room
+void prime_file_append_begin( PrimeFileAppend *append, u32 file, PrimeFileFormat format, u64 low, u64 high, u64 blockSize );
+/// @desc Appends primes above any written so far (raw and gap formats)
+void prime_file_append( PrimeFileAppend *append, const u64 *primes, u64 count );
+/// @desc Appends the next bytes of the bitmap holding count primes (bitmap format)
+void prime_file_append_bits( PrimeFileAppend *append, const u8 *bits, u64 size, u64 count );
+bool prime_file_commit( PrimeFileAppend *append );
+/// @desc Commits what is left as every prime below limit, writes the trailer and stops the writer, call before
+/// closing the file
+bool prime_file_append_end( PrimeFileAppend *append, u64 limit );
+/// @desc Stops the writer without committing anything more, the header stays at the last commit as if the run had
+/// been interrupted
+void prime_file_append_cancel( PrimeFileAppend *append );
+
+// Reads the primes of a raw or gap prime file, up to the count of its header
+struct PrimeFileReader
+{
+	u32 fileID;
+	PrimeFileHeader header;
+	PrimeFileFormat format;
+	u64 count;								// primes in the file
+	u64 position;							// ordinal of the next prime read
+
+	// Gap format
+	std::vector<PrimeGapBlock> index;
+	std::vector<u8> block;
+	u64 blockIndex;							// block loaded into block, index.size() for none
+	u64 blockOffset;						// next gap byte in the block
+	u64 next;								// prime at position, while a block is loaded
+};
+
+/// @desc Reads the header of file (at any position) and loads the index of a gap file, rebuilding it from the block
+/// headers if the writer never got to close the file
+bool prime_file_read_begin( PrimeFileReader *reader, u32 file );
+/// @desc Moves to the prime with the given ordinal (0 is 2), the index narrows it down to one block
+bool prime_file_read_seek( PrimeFileReader *reader, u64 ordinal );
+/// @desc Reads up to count primes, returns how many were read
+u64 prime_file_read( PrimeFileReader *reader, u64 *primes, u64 count );
+
+/// @desc Carries on appending the primes below high to the file reader opened after its committed data, anything past
+/// that (the tail of an interrupted run, the trailer of a closed file) is cut off first
+bool prime_file_append_resume( PrimeFileAppend *append, PrimeFileReader *reader, u64 high, u64 blockSize );
+
+/// @desc Checks the data of the prime file at path against its checksums, threadCount blocks at a time
+bool prime_file_verify( const char *path, u32 threadCount );
+
+// Membership of every integer below limit, the wheel bytes of a mapped PRIME_BITMAP_FILE
+struct PrimeBitmap
+{
+	const u8 *bits;
+	u64 size;								// bytes of bits
+	u64 count;
+	u64 limit;
+	MappedFile mapping;
+};
+
+bool prime_bitmap_load( PrimeBitmap *bitmap, const char *path );
+void prime_bitmap_free( PrimeBitmap *bitmap );
+/// @desc A single bit test, value has to be below limit
+[[nodiscard]] bool prime_bitmap_is_prime( const PrimeBitmap *bitmap, u64 value );
+/// @desc Smallest prime above value, 0 if there is none below limit
+[[nodiscard]] u64 prime_bitmap_next( const PrimeBitmap *bitmap, u64 value );
+/// @desc Largest prime below value (only those below limit are known), 0 if there is none
+[[nodiscard]] u64 prime_bitmap_previous( const PrimeBitmap *bitmap, u64 value );
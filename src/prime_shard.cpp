@@ -0,0 +1,262 @@
+void prime_manifest_plan( PrimeManifest *manifest, u64 to, u32 count, PrimeFileFormat format )
+{
+	manifest->to = to;
+	manifest->format = format;
+	manifest->shards.resize( count );
+
+	// The first extra shards get one more integer each, to - 2 might not divide evenly
+	u64 span = ( to > 2 ) ? to - 2 : 0;
+	u64 perShard = span / count;
+	u64 extra = span % count;
+	u64 low = 2;
+
+	for ( u32 i = 0; i < count; ++i )
+	{
+		PrimeShard &shard = manifest->shards[ i ];
+
+		shard.low = low;
+		shard.high = low + perShard + ( i < extra );
+		string_utf8_format( shard.path, PRIME_SHARD_FILE, i );
+
+		low = shard.high;
+	}
+}
+
+bool prime_manifest_write( const PrimeManifest *manifest, const char *path )
+{
+	u32 file = platform_open_file( path, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( file == INVALID_FILE_INDEX )
+	{
+		show_log_warning( "Failed to create or open file: %s", path );
+		return false;
+	}
+
+	bool written = true;
+
+	write_file_line( file, &written, "version %u\n", PRIME_SHARD_MANIFEST_VERSION );
+	write_file_line( file, &written, "to %llu\n", manifest->to );
+	write_file_line( file, &written, "format %s\n", ( manifest->format == PRIME_FILE_FORMAT_GAP ) ? "gap" : "raw" );
+	write_file_line( file, &written, "shards %llu\n", static_cast<u64>( manifest->shards.size() ) );
+
+	for ( u64 i = 0; i < manifest->shards.size(); ++i )
+	{
+		const PrimeShard &shard = manifest->shards[ i ];
+		write_file_line( file, &written, "%llu %llu %llu %s\n", i, shard.low, shard.high, shard.path );
+	}
+
+	platform_close_file( file );
+
+	if ( !written )
+		show_log_warning( "Failed to write file: %s", path );
+
+	return written;
+}
+
+bool prime_manifest_read( PrimeManifest *manifest, const char *path )
+{
+	u32 file = platform_open_file( path, FILE_OPTION_READ );
+	if ( file == INVALID_FILE_INDEX )
+		return false;
+
+	std::vector<char> text( platform_get_file_size( file ) + 1, '\0' );
+	bool read = platform_read_from_file( file, text.data(), text.size() - 1 ) == text.size() - 1;
+
+	platform_close_file( file );
+
+	if ( !read )
+		return false;
+
+	u32 version = 0;
+	u64 count = 0;
+	char format[ 8 ] = {};
+	u64 line = 0;
+
+	manifest->to = 0;
+	manifest->shards.clear();
+
+	// One setting or shard per line, anything else is an error rather than a guess
+	for ( char *next = text.data(); *next; ++line )
+	{
+		char *current = next;
+		char *end = strchr( current, '\n' );
+
+		if ( end )
+		{
+			*end = '\0';
+			next = end + 1;
+		}
+		else
+		{
+			next = current + strlen( current );
+		}
+
+		u64 index;
+		PrimeShard shard = {};
+
+		bool parsed =
+			( line == 0 && sscanf( current, "version %u", &version ) == 1 ) ||
+			( line == 1 && sscanf( current, "to %llu", &manifest->to ) == 1 ) ||
+			( line == 2 && sscanf( current, "format %7s", format ) == 1 ) ||
+			( line == 3 && sscanf( current, "shards %llu", &count ) == 1 );
+
+		if ( !parsed && line > 3 && sscanf( current, "%llu %llu %llu %63s", &index, &shard.low, &shard.high, shard.path ) == 4 && index == manifest->shards.size() )
+		{
+			manifest->shards.push_back( shard );
+			parsed = true;
+		}
+
+		if ( !parsed && current[ strspn( current, " \t\r" ) ] != '\0' )
+		{
+			show_log_warning( "%s line %llu not understood: %s", path, line + 1, current );
+			return false;
+		}
+	}
+
+	if ( version != PRIME_SHARD_MANIFEST_VERSION )
+	{
+		show_log_warning( "%s is not a version %u manifest.", path, PRIME_SHARD_MANIFEST_VERSION );
+		return false;
+	}
+
+	if ( string_utf8_compare( format, "raw" ) )
+	{
+		manifest->format = PRIME_FILE_FORMAT_RAW;
+	}
+	else if ( string_utf8_compare( format, "gap" ) )
+	{
+		manifest->format = PRIME_FILE_FORMAT_GAP;
+	}
+	else
+	{
+		show_log_warning( "%s has an unknown format: %s", path, format );
+		return false;
+	}
+
+	if ( count == 0 || count > PRIME_SHARD_MAX || count != manifest->shards.size() )
+	{
+		show_log_warning( "%s lists %llu shards, it says there are %llu.", path, static_cast<u64>( manifest->shards.size() ), count );
+		return false;
+	}
+
+	// Every integer of [2, to) belongs to exactly one shard
+	u64 low = 2;
+
+	for ( const PrimeShard &shard : manifest->shards )
+	{
+		if ( shard.low != low || shard.high < shard.low )
+		{
+			show_log_warning( "%s: shard %s does not start where the one before it ends.", path, shard.path );
+			return false;
+		}
+
+		low = shard.high;
+	}
+
+	if ( low != manifest->to )
+	{
+		show_log_warning( "%s: the shards end at %llu rather than %llu.", path, low, manifest->to );
+		return false;
+	}
+
+	return true;
+}
+
+/// @desc Opens a shard for reading if it is finished, matches its checksums and covers exactly its slice
+static u32 prime_shard_open( const PrimeShard *shard, u32 threadCount, PrimeFileReader *reader )
+{
+	if ( !prime_file_verify( shard->path, threadCount ) )
+		return INVALID_FILE_INDEX;
+
+	u32 file = platform_open_file( shard->path, FILE_OPTION_READ );
+	if ( file == INVALID_FILE_INDEX )
+		return INVALID_FILE_INDEX;
+
+	if ( !prime_file_read_begin( reader, file ) )
+	{
+		platform_close_file( file );
+		return INVALID_FILE_INDEX;
+	}
+
+	if ( reader->header.low != shard->low || reader->header.limit != shard->high )
+	{
+		show_log_warning( "%s covers [%llu, %llu) rather than [%llu, %llu).", shard->path, reader->header.low, reader->header.limit, shard->low, shard->high );
+		platform_close_file( file );
+		return INVALID_FILE_INDEX;
+	}
+
+	return file;
+}
+
+bool prime_shards_merge( const PrimeManifest *manifest, const char *path, u32 threadCount, u64 blockSize, u64 *found )
+{
+	// Every shard is checked before the merged file is touched, a bad shard leaves any old file as it was
+	u64 expected = 0;
+
+	for ( const PrimeShard &shard : manifest->shards )
+	{
+		PrimeFileReader reader;
+		u32 file = prime_shard_open( &shard, threadCount, &reader );
+
+		if ( file == INVALID_FILE_INDEX )
+		{
+			show_log_warning( "Shard %s is missing, unfinished or damaged, generate it again.", shard.path );
+			return false;
+		}
+
+		expected += reader.count;
+		platform_close_file( file );
+	}
+
+	u32 output = platform_open_file( path, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( output == INVALID_FILE_INDEX )
+	{
+		show_log_warning( "Failed to create or open file: %s", path );
+		return false;
+	}
+
+	PrimeFileAppend append;
+	prime_file_append_begin( &append, output, manifest->format, 2, manifest->to, blockSize );
+
+	std::vector<u64> primes( PRIME_FILE_CHECKPOINT_PRIMES / 16 );
+	bool merged = true;
+
+	for ( u64 i = 0; i < manifest->shards.size() && merged; ++i )
+	{
+		const PrimeShard &shard = manifest->shards[ i ];
+		PrimeFileReader reader;
+
+		u32 file = platform_open_file( shard.path, FILE_OPTION_READ );
+		merged = file != INVALID_FILE_INDEX && prime_file_read_begin( &reader, file );
+
+		while ( merged && reader.position < reader.count )
+		{
+			u64 count = prime_file_read( &reader, primes.data(), primes.size() );
+
+			merged = count > 0;
+			prime_file_append( &append, primes.data(), count );
+		}
+
+		if ( file != INVALID_FILE_INDEX )
+			platform_close_file( file );
+
+		verbose_log_message( "Merged %s.", shard.path );
+	}
+
+	// A shard that failed to read must not leave a file claiming to cover the whole manifest
+	if ( merged )
+		merged = prime_file_append_end( &append, manifest->to );
+	else
+		prime_file_append_cancel( &append );
+
+	platform_close_file( output );
+
+	if ( !merged || append.header.count != expected )
+	{
+		show_log_warning( "Failed to merge the shards into %s.", path );
+		return false;
+	}
+
+	*found = append.header.count;
+
+	return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Generation split into shards, each a prime file of a disjoint slice of [2, to) that any machine can produce
+// on its own. The manifest is the plan every worker reads its slice from, a text file of
+//	version <PRIME_SHARD_MANIFEST_VERSION>
+//	to <to>
+//	format <raw|gap>
+//	shards <count>
+//	<index> <low> <high> <file>				(one line per shard, [low, high) in ascending order)
+// Merging checks every shard against the plan and its checksums before stitching them into PRIME_NUMBER_FILE.
+// -shards runs the shards in local processes, which only the Windows platform layer can start. Anywhere else the
+// shards are run by hand: -manifest, then -shard i in a process for each, then -merge.
+#define PRIME_SHARD_MANIFEST_VERSION			( 1 )
+#define PRIME_SHARD_MAX							( 1024 )
+
+struct PrimeShard
+{
+	u64 low;
+	u64 high;
+	char path[ 64 ];
+};
+
+struct PrimeManifest
+{
+	u64 to;
+	PrimeFileFormat format;
+	std::vector<PrimeShard> shards;
+};
+
+/// @desc Splits [2, to) into count slices of about the same width, the sieve costs about the same for each
+void prime_manifest_plan( PrimeManifest *manifest, u64 to, u32 count, PrimeFileFormat format );
+bool prime_manifest_write( const PrimeManifest *manifest, const char *path );
+/// @desc Reads and checks the manifest at path, the shards have to cover [2, to) without gaps or overlaps
+bool prime_manifest_read( PrimeManifest *manifest, const char *path );
+
+/// @desc Stitches the shards of the manifest into one prime file at path in the format of the manifest. Every shard
+/// has to be finished, cover exactly its slice and match its checksums. The number of primes merged is written to found.
+/// @return false when a shard is bad or the merged file can't be written, found is left alone then
+bool prime_shards_merge( const PrimeManifest *manifest, const char *path, u32 threadCount, u64 blockSize, u64 *found );
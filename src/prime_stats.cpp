@@ -0,0 +1,167 @@
+[[nodiscard]] static inline u64 prime_stats_gap_slot( u64 gap )
+{
+	u64 slot = gap / 2;
+	return ( slot < PRIME_STATS_GAP_SLOTS ) ? slot : PRIME_STATS_GAP_SLOTS - 1;
+}
+
+[[nodiscard]] static inline u64 prime_stats_slot_gap( u64 slot )
+{
+	return slot ? 2 * slot : 1;
+}
+
+void prime_stats_begin( PrimeStats *stats, u64 from )
+{
+	memset( stats, 0, sizeof( PrimeStats ) );
+
+	stats->from = from;
+	stats->to = from;
+}
+
+void prime_stats_add( PrimeStats *stats, const u64 *primes, u64 count )
+{
+	if ( count == 0 )
+		return;
+
+	u64 i = 0;
+
+	if ( stats->count == 0 )
+	{
+		stats->first = primes[ 0 ];
+		stats->last = primes[ 0 ];
+		stats->residues[ primes[ 0 ] % PRIME_STATS_RESIDUE_MODULUS ] += 1;
+		i = 1;
+	}
+
+	u64 previous = stats->last;
+
+	for ( ; i < count; ++i )
+	{
+		u64 p = primes[ i ];
+		u64 slot = prime_stats_gap_slot( p - previous );
+
+		stats->gaps[ slot ] += 1;
+
+		if ( !stats->firstOccurrence[ slot ] )
+			stats->firstOccurrence[ slot ] = previous;
+
+		stats->residues[ p % PRIME_STATS_RESIDUE_MODULUS ] += 1;
+		previous = p;
+	}
+
+	stats->last = previous;
+	stats->count += count;
+}
+
+inline void prime_stats_end( PrimeStats *stats, u64 to )
+{
+	stats->to = to;
+}
+
+void prime_stats_merge( PrimeStats *stats, const PrimeStats *next )
+{
+	if ( next->count == 0 )
+	{
+		stats->to = next->to;
+		return;
+	}
+
+	if ( stats->count == 0 )
+	{
+		u64 from = stats->from;
+		*stats = *next;
+		stats->from = from;
+		return;
+	}
+
+	// The gap across the boundary belongs to neither range on its own
+	u64 slot = prime_stats_gap_slot( next->first - stats->last );
+
+	stats->gaps[ slot ] += 1;
+
+	if ( !stats->firstOccurrence[ slot ] )
+		stats->firstOccurrence[ slot ] = stats->last;
+
+	for ( u64 i = 0; i < PRIME_STATS_GAP_SLOTS; ++i )
+	{
+		stats->gaps[ i ] += next->gaps[ i ];
+
+		if ( !stats->firstOccurrence[ i ] )
+			stats->firstOccurrence[ i ] = next->firstOccurrence[ i ];
+	}
+
+	for ( u64 i = 0; i < PRIME_STATS_RESIDUE_MODULUS; ++i )
+		stats->residues[ i ] += next->residues[ i ];
+
+	stats->count += next->count;
+	stats->last = next->last;
+	stats->to = next->to;
+}
+
+bool prime_stats_write( const PrimeStats *stats, const char *path )
+{
+	u32 file = platform_open_file( path, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( file == INVALID_FILE_INDEX )
+	{
+		show_log_warning( "Failed to create or open file: %s", path );
+		return false;
+	}
+
+	bool written = true;
+
+	write_file_line( file, &written, "version %u\n", PRIME_STATS_VERSION );
+	write_file_line( file, &written, "from %llu\n", stats->from );
+	write_file_line( file, &written, "to %llu\n", stats->to );
+	write_file_line( file, &written, "primes %llu\n", stats->count );
+	write_file_line( file, &written, "first %llu\n", stats->first );
+	write_file_line( file, &written, "last %llu\n", stats->last );
+	write_file_line( file, &written, "twins %llu\n", stats->gaps[ 1 ] );
+
+	// Walking down from the largest gap, a gap is maximal when it came before every larger one
+	u32 maximal[ PRIME_STATS_GAP_SLOTS ];
+	u32 maximalCount = 0;
+	u32 gapCount = 0;
+	u64 earliest = UINT64_MAX;
+
+	for ( u32 slot = PRIME_STATS_GAP_SLOTS; slot-- > 0; )
+	{
+		if ( !stats->gaps[ slot ] )
+			continue;
+
+		++gapCount;
+
+		if ( stats->firstOccurrence[ slot ] < earliest )
+		{
+			earliest = stats->firstOccurrence[ slot ];
+			maximal[ maximalCount++ ] = slot;
+		}
+	}
+
+	// <gap> <prime it follows>
+	write_file_line( file, &written, "maximal_gaps %u\n", maximalCount );
+	for ( u32 i = maximalCount; i-- > 0; )
+		write_file_line( file, &written, "%llu %llu\n", prime_stats_slot_gap( maximal[ i ] ), stats->firstOccurrence[ maximal[ i ] ] );
+
+	// <gap> <occurrences> <prime the first one follows>
+	write_file_line( file, &written, "gaps %u\n", gapCount );
+	for ( u32 slot = 0; slot < PRIME_STATS_GAP_SLOTS; ++slot )
+		if ( stats->gaps[ slot ] )
+			write_file_line( file, &written, "%llu %llu %llu\n", prime_stats_slot_gap( slot ), stats->gaps[ slot ], stats->firstOccurrence[ slot ] );
+
+	u32 residueCount = 0;
+
+	for ( u32 residue = 0; residue < PRIME_STATS_RESIDUE_MODULUS; ++residue )
+		residueCount += ( stats->residues[ residue ] != 0 );
+
+	// <residue> <primes>, the classes that hold any
+	write_file_line( file, &written, "residues %u\n", residueCount );
+	for ( u32 residue = 0; residue < PRIME_STATS_RESIDUE_MODULUS; ++residue )
+		if ( stats->residues[ residue ] )
+			write_file_line( file, &written, "%u %llu\n", residue, stats->residues[ residue ] );
+
+	platform_close_file( file );
+
+	if ( !written )
+		show_log_warning( "Failed to write file: %s", path );
+
+	return written;
+}
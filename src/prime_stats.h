@@ -0,0 +1,34 @@
+#pragma once
+
+// Statistics of the primes in a range, tallied as the sieve hands them over so a table never needs a second pass.
+// Each worker of the parallel sieve tallies its own chunk and the chunks are merged in order, the gap across the
+// boundary of two chunks is only known once both are. Maximal gaps are not kept, a gap is maximal exactly when it
+// first occurs before every larger gap first occurs, so the report works them out from the first occurrences.
+// Gap g is kept in slot g / 2 (the gap of 1 from 2 to 3 in slot 0), every gap between primes below 2^64 fits.
+#define PRIME_STATS_VERSION						( 1 )
+#define PRIME_STATS_GAP_SLOTS					( 1024 )
+#define PRIME_STATS_RESIDUE_MODULUS				( 60 )				// 3, 4 and 5 at once, for the races between classes
+
+struct PrimeStats
+{
+	u64 from;								// first integer tallied
+	u64 to;									// every prime in [from, to) is tallied
+	u64 count;
+	u64 first;								// first prime, 0 when there are none
+	u64 last;								// last prime
+	u64 gaps[ PRIME_STATS_GAP_SLOTS ];				// how many times each gap occurs, slot 1 counts the twins
+	u64 firstOccurrence[ PRIME_STATS_GAP_SLOTS ];	// prime before the first of each gap, 0 for none yet
+	u64 residues[ PRIME_STATS_RESIDUE_MODULUS ];	// primes in each class mod PRIME_STATS_RESIDUE_MODULUS
+};
+
+/// @desc Starts empty statistics of the primes from from onwards
+void prime_stats_begin( PrimeStats *stats, u64 from );
+/// @desc Tallies primes above any tallied so far
+void prime_stats_add( PrimeStats *stats, const u64 *primes, u64 count );
+/// @desc Marks every prime below to as tallied
+inline void prime_stats_end( PrimeStats *stats, u64 to );
+/// @desc Adds the statistics of the range that starts where stats ends
+void prime_stats_merge( PrimeStats *stats, const PrimeStats *next );
+
+/// @desc Writes the statistics as text: the totals, the maximal gaps, then a line per gap and per residue class
+bool prime_stats_write( const PrimeStats *stats, const char *path );
@@ -0,0 +1,180 @@
+#pragma once
+
+// Tables worked out by the compiler. They end up in read only data, so nothing is built at startup and every run
+// uses the same bytes. The generators are consteval, a table can only come from a constant evaluation.
+#define SMALL_PRIME_LIMIT						( 1u << 16 )
+
+// Divisibility by an odd prime without dividing (Granlund and Montgomery). Multiplying by the inverse of p mod 2^64
+// maps the multiples of p onto 0 .. limit and everything else above it, and for a multiple it gives the quotient.
+struct TrialDivisor
+{
+	u64 inverse;							// p * inverse = 1 mod 2^64
+	u64 limit;								// ( 2^64 - 1 ) / p
+};
+
+[[nodiscard]] constexpr inline bool trial_divides( const TrialDivisor &divisor, u64 value )
+{
+	return value * divisor.inverse <= divisor.limit;
+}
+
+/// @desc value / p for a multiple of p
+[[nodiscard]] constexpr inline u64 trial_divide_exact( const TrialDivisor &divisor, u64 value )
+{
+	return value * divisor.inverse;
+}
+
+[[nodiscard]] constexpr inline TrialDivisor trial_divisor( u64 p )
+{
+	// Newton's iteration doubles the correct low bits each step, an odd p is its own inverse to 3 bits
+	u64 inverse = p;
+	for ( u32 i = 0; i < 5; ++i )
+		inverse *= 2 - p * inverse;
+
+	return { .inverse = inverse, .limit = UINT64_MAX / p };
+}
+
+template <u32 Count>
+struct SmallPrimeTable
+{
+	static constexpr u32 COUNT = Count;
+
+	u32 primes[ Count ];					// the odd primes, ascending
+	TrialDivisor divisors[ Count ];			// divisors[ i ] tests for primes[ i ]
+};
+
+/// @desc Sieves the odd numbers below Limit, writing the primes to primes when given
+/// @return The number of odd primes below Limit
+template <u32 Limit>
+consteval u32 small_prime_sieve( u32 *primes )
+{
+	// Index i is the odd number 2i + 1
+	bool composite[ Limit / 2 ] = {};
+	u32 count = 0;
+
+	for ( u32 i = 1; i < Limit / 2; ++i )
+	{
+		if ( composite[ i ] )
+			continue;
+
+		u32 p = 2 * i + 1;
+
+		if ( primes )
+			primes[ count ] = p;
+
+		++count;
+
+		for ( u64 j = static_cast<u64>( p ) * p / 2; j < Limit / 2; j += p )
+			composite[ j ] = true;
+	}
+
+	return count;
+}
+
+template <u32 Limit>
+consteval SmallPrimeTable<small_prime_sieve<Limit>( nullptr )> small_prime_table()
+{
+	SmallPrimeTable<small_prime_sieve<Limit>( nullptr )> table = {};
+
+	small_prime_sieve<Limit>( table.primes );
+
+	for ( u32 i = 0; i < table.COUNT; ++i )
+		table.divisors[ i ] = trial_divisor( table.primes[ i ] );
+
+	return table;
+}
+
+// The odd primes below SMALL_PRIME_LIMIT (6541 of them), every odd prime a u32 square root can need
+inline constexpr auto SMALL_PRIMES = small_prime_table<SMALL_PRIME_LIMIT>();
+
+/// @desc Index of the first small prime above value, SMALL_PRIMES.COUNT when there is none
+[[nodiscard]] constexpr inline u32 small_prime_upper_bound( u64 value )
+{
+	u32 low = 0;
+	u32 high = SMALL_PRIMES.COUNT;
+
+	while ( low < high )
+	{
+		u32 middle = ( low + high ) / 2;
+
+		if ( SMALL_PRIMES.primes[ middle ] <= value )
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+// The residues coprime to Modulus, the integers a wheel sieve of that modulus keeps
+template <u32 Modulus>
+consteval u32 wheel_size()
+{
+	u32 size = 0;
+
+	for ( u32 r = 1; r < Modulus; ++r )
+	{
+		u32 a = r;
+		u32 b = Modulus;
+
+		while ( b )
+		{
+			u32 t = a % b;
+			a = b;
+			b = t;
+		}
+
+		size += ( a == 1 );
+	}
+
+	return size;
+}
+
+template <u32 Modulus>
+struct WheelTable
+{
+	static constexpr u32 MODULUS = Modulus;
+	static constexpr u32 SIZE = wheel_size<Modulus>();
+
+	u8 offsets[ SIZE ];						// the coprime residues, ascending
+	u8 steps[ SIZE ];						// offsets[ i ] + steps[ i ] is the next coprime residue (past the modulus for the last)
+	u8 index[ Modulus ];					// position of a residue in offsets, 0xFF when it shares a factor with Modulus
+};
+
+template <u32 Modulus>
+consteval WheelTable<Modulus> wheel_table()
+{
+	static_assert( Modulus <= 256, "The wheel tables hold residues in bytes." );
+
+	WheelTable<Modulus> table = {};
+	u32 size = 0;
+
+	for ( u32 r = 0; r < Modulus; ++r )
+		table.index[ r ] = 0xFF;
+
+	for ( u32 r = 1; r < Modulus; ++r )
+	{
+		u32 a = r;
+		u32 b = Modulus;
+
+		while ( b )
+		{
+			u32 t = a % b;
+			a = b;
+			b = t;
+		}
+
+		if ( a != 1 )
+			continue;
+
+		table.index[ r ] = static_cast<u8>( size );
+		table.offsets[ size++ ] = static_cast<u8>( r );
+	}
+
+	for ( u32 i = 0; i < table.SIZE; ++i )
+	{
+		u32 next = ( i + 1 < table.SIZE ) ? table.offsets[ i + 1 ] : Modulus + table.offsets[ 0 ];
+		table.steps[ i ] = static_cast<u8>( next - table.offsets[ i ] );
+	}
+
+	return table;
+}
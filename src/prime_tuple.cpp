@@ -0,0 +1,134 @@
+// A byte pattern repeated in each byte of a u64
+#define PRIME_TUPLE_BYTES( pattern )			( 0x0101010101010101ull * ( pattern ) )
+
+PrimeTuple prime_tuple_from_name( const char *name )
+{
+	for ( PrimeTuple tuple = 0; tuple < PRIME_TUPLE_COUNT; ++tuple )
+		if ( string_utf8_compare( name, PRIME_TUPLE_NAMES[ tuple ] ) )
+			return tuple;
+
+	return PRIME_TUPLE_COUNT;
+}
+
+[[nodiscard]] inline u64 prime_tuple_sieve_end( u64 to )
+{
+	return ( ( to + 29 ) / 30 + 1 ) * 30;
+}
+
+void prime_tuple_small( PrimeTuple tuple, u64 limit, std::vector<u64> &firsts )
+{
+	// 3, 5 / 3, 7 / 5, 11 / 5, 7, 11 / 2, 5 and 3, 7 and 5, 11
+	static constexpr u8 SMALL_FIRSTS[ PRIME_TUPLE_COUNT ][ 4 ] = { { 3, 5 }, { 3 }, { 5 }, { 5 }, { 2, 3, 5 } };
+
+	for ( u8 first : SMALL_FIRSTS[ tuple ] )
+		if ( first && first < limit )
+			firsts.push_back( first );
+}
+
+/// @desc Bits of word (8 wheel bytes) that start a tuple, next is the same bytes moved along one
+template <PrimeTuple Tuple>
+[[nodiscard]] static inline u64 prime_tuple_mask( u64 word, u64 next, const u8 *doubled )
+{
+	// Bits 0 - 7 of a byte are 1, 7, 11, 13, 17, 19, 23, 29
+	if constexpr ( Tuple == PRIME_TUPLE_TWIN )
+	{
+		// 11 13, 17 19 and 29 with the 31 of the next byte
+		return ( word & ( word >> 1 ) & PRIME_TUPLE_BYTES( 0x14 ) ) | ( word & ( next << 7 ) & PRIME_TUPLE_BYTES( 0x80 ) );
+	}
+	else if constexpr ( Tuple == PRIME_TUPLE_COUSIN )
+	{
+		// 7 11, 13 17, 19 23
+		return word & ( word >> 1 ) & PRIME_TUPLE_BYTES( 0x2A );
+	}
+	else if constexpr ( Tuple == PRIME_TUPLE_SEXY )
+	{
+		// 1 7, 23 29 are neighbouring bits, 7 13, 11 17, 13 19, 17 23 are two apart
+		return ( word & ( word >> 1 ) & PRIME_TUPLE_BYTES( 0x41 ) ) | ( word & ( word >> 2 ) & PRIME_TUPLE_BYTES( 0x1E ) );
+	}
+	else if constexpr ( Tuple == PRIME_TUPLE_TRIPLET )
+	{
+		// 7 11 13, 11 13 17, 13 17 19, 17 19 23, three bits in a row either way
+		return word & ( word >> 1 ) & ( word >> 2 ) & PRIME_TUPLE_BYTES( 0x1E );
+	}
+	else
+	{
+		// 2p + 1 of 30k + 11 is 60k + 23, of 30k + 23 is 60k + 47 and of 30k + 29 is 60k + 59
+		u64 mask = 0;
+
+		for ( u32 i = 0; i < 8; ++i )
+		{
+			u64 even = doubled[ 2 * i ];
+			u64 odd = doubled[ 2 * i + 1 ];
+
+			mask |= ( ( ( even >> 6 ) & 1 ) << 2 | ( ( odd >> 4 ) & 1 ) << 6 | ( odd & 0x80 ) ) << ( 8 * i );
+		}
+
+		return word & mask;
+	}
+}
+
+/// @desc Appends the tuples of the bits of mask below limit, bit i being in byte byte + i / 8
+static inline void prime_tuple_emit( u64 mask, u64 byte, u64 limit, std::vector<u64> &firsts )
+{
+	while ( mask )
+	{
+		u32 bit = count_trailing_zeros( mask );
+		u64 p = 30 * ( byte + bit / 8 ) + WHEEL.offsets[ bit % 8 ];
+
+		if ( p >= limit )
+			return;
+
+		firsts.push_back( p );
+		mask &= mask - 1;
+	}
+}
+
+template <PrimeTuple Tuple>
+static void prime_tuple_scan_with( u64 firstByte, const u8 *bits, u64 bytes, const u8 *doubled, u64 limit, std::vector<u64> &firsts )
+{
+	u64 i = 0;
+
+	for ( ; i + 8 <= bytes; i += 8 )
+	{
+		u64 word;
+		memcpy( &word, bits + i, sizeof( word ) );
+
+		u64 next = ( word >> 8 ) | ( static_cast<u64>( bits[ i + 8 ] ) << 56 );
+		u64 mask = prime_tuple_mask<Tuple>( word, next, doubled ? doubled + 2 * i : nullptr );
+
+		prime_tuple_emit( mask, firstByte + i, limit, firsts );
+	}
+
+	if ( i == bytes )
+		return;
+
+	// The last few bytes (and the one after) go through a zeroed word, anything past them is masked off
+	u64 left = bytes - i;
+	u8 tail[ 16 ] = {};
+	u8 tailDoubled[ 16 ] = {};
+
+	memcpy( tail, bits + i, left + 1 );
+	if ( doubled )
+		memcpy( tailDoubled, doubled + 2 * i, 2 * left );
+
+	u64 word;
+	u64 next;
+	memcpy( &word, tail, sizeof( word ) );
+	memcpy( &next, tail + 1, sizeof( next ) );
+
+	u64 mask = prime_tuple_mask<Tuple>( word, next, tailDoubled ) & ( ( 1ull << ( 8 * left ) ) - 1 );
+
+	prime_tuple_emit( mask, firstByte + i, limit, firsts );
+}
+
+void prime_tuple_scan( PrimeTuple tuple, u64 firstByte, const u8 *bits, u64 bytes, const u8 *doubled, u64 limit, std::vector<u64> &firsts )
+{
+	switch ( tuple )
+	{
+	case PRIME_TUPLE_TWIN:				prime_tuple_scan_with<PRIME_TUPLE_TWIN>( firstByte, bits, bytes, doubled, limit, firsts ); break;
+	case PRIME_TUPLE_COUSIN:			prime_tuple_scan_with<PRIME_TUPLE_COUSIN>( firstByte, bits, bytes, doubled, limit, firsts ); break;
+	case PRIME_TUPLE_SEXY:				prime_tuple_scan_with<PRIME_TUPLE_SEXY>( firstByte, bits, bytes, doubled, limit, firsts ); break;
+	case PRIME_TUPLE_TRIPLET:			prime_tuple_scan_with<PRIME_TUPLE_TRIPLET>( firstByte, bits, bytes, doubled, limit, firsts ); break;
+	case PRIME_TUPLE_SOPHIE_GERMAIN:	prime_tuple_scan_with<PRIME_TUPLE_SOPHIE_GERMAIN>( firstByte, bits, bytes, doubled, limit, firsts ); break;
+	}
+}
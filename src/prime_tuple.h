@@ -0,0 +1,39 @@
+#pragma once
+
+// Prime k-tuples read straight off the wheel bytes of the sieve, no list of primes is ever made.
+// Each byte holds bits for 30k + 1, 7, 11, 13, 17, 19, 23, 29, so a tuple is a pattern of bits a fixed distance
+// apart: the bytes are loaded 8 at a time and ANDed with themselves shifted by that distance (only twins can
+// reach the next byte, 29 and 31). A Sophie Germain prime p needs 2p + 1 prime as well, which the same sieve finds
+// in the doubled range. p % 30 has to be 11, 23 or 29 and 2p + 1 lands in byte 2k or 2k + 1 of it.
+// The tuples are listed by their first member, every tuple that starts below the limit is listed even if it
+// ends past it.
+#define PRIME_TUPLE_MAX							( 1ull << 62 )		// highest number searched, the doubled range has to fit a u64
+
+using PrimeTuple = u32;
+enum PRIME_TUPLE : PrimeTuple
+{
+	PRIME_TUPLE_TWIN,						// p, p + 2
+	PRIME_TUPLE_COUSIN,						// p, p + 4
+	PRIME_TUPLE_SEXY,						// p, p + 6
+	PRIME_TUPLE_TRIPLET,					// p, p + 2, p + 6 or p, p + 4, p + 6
+	PRIME_TUPLE_SOPHIE_GERMAIN,				// p, 2p + 1
+	PRIME_TUPLE_COUNT,
+};
+
+// The name on the command line and in PRIME_TUPLE_FILE
+inline constexpr const char *PRIME_TUPLE_NAMES[ PRIME_TUPLE_COUNT ] = { "twins", "cousins", "sexy", "triplets", "sophie_germain" };
+
+/// @return The tuple called name, PRIME_TUPLE_COUNT for none
+[[nodiscard]] PrimeTuple prime_tuple_from_name( const char *name );
+
+/// @desc End of the range to sieve for the tuples starting below to, a whole byte further so those ending in the
+/// next byte are seen (the doubled range of Sophie Germain primes ends at twice this)
+[[nodiscard]] inline u64 prime_tuple_sieve_end( u64 to );
+
+/// @desc Appends the tuples below limit starting at 2, 3 or 5, which have no bits
+void prime_tuple_small( PrimeTuple tuple, u64 limit, std::vector<u64> &firsts );
+
+/// @desc Appends the first member of each tuple starting in the bytes of bits, the first of them being byte firstByte
+/// of the wheel. bits[ bytes ] has to be there too (the following byte). doubled holds bytes 2 * firstByte onwards
+/// of the doubled range for Sophie Germain primes, two per byte of bits.
+void prime_tuple_scan( PrimeTuple tuple, u64 firstByte, const u8 *bits, u64 bytes, const u8 *doubled, u64 limit, std::vector<u64> &firsts );
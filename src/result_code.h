@@ -8,6 +8,8 @@ enum RESULT_CODE : u32
 	RESULT_CODE_UNKNOWN_OPTIONAL_COMMAND,
 	RESULT_CODE_FAILED_TO_INITIALISE_MEMORY_ARENA,
 	RESULT_CODE_FAILED_TO_INITIALISE_PLATFORM,
+	RESULT_CODE_INVALID_OPTIONAL_ARGUMENT,
+	RESULT_CODE_TASK_FAILED,
 };
 
 static const char *error_code_string( RESULT_CODE code )
@@ -19,6 +21,8 @@ static const char *error_code_string( RESULT_CODE code )
 	case RESULT_CODE_UNKNOWN_OPTIONAL_COMMAND: return "RESULT_CODE_UNKNOWN_OPTIONAL_COMMAND";
 	case RESULT_CODE_FAILED_TO_INITIALISE_MEMORY_ARENA: return "RESULT_CODE_FAILED_TO_INITIALISE_MEMORY_ARENA";
 	case RESULT_CODE_FAILED_TO_INITIALISE_PLATFORM: return "RESULT_CODE_FAILED_TO_INITIALISE_PLATFORM";
+	case RESULT_CODE_INVALID_OPTIONAL_ARGUMENT: return "RESULT_CODE_INVALID_OPTIONAL_ARGUMENT";
+	case RESULT_CODE_TASK_FAILED: return "RESULT_CODE_TASK_FAILED";
 	}
 
 	return "UNKNOWN ERROR CODE";
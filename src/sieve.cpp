@@ -0,0 +1,473 @@
+void sieve_small_primes( u32 limit, std::vector<u32> &primes )
+{
+	primes.clear();
+
+	if ( limit < 3 )
+		return;
+
+	// The compiler already sieved these
+	if ( limit < SMALL_PRIME_LIMIT )
+	{
+		primes.assign( SMALL_PRIMES.primes, SMALL_PRIMES.primes + small_prime_upper_bound( limit ) );
+		return;
+	}
+
+	// Small enough to sieve in one go (index i is the odd number 2i + 1)
+	if ( limit <= SIEVE_SMALL_PRIMES_DIRECT_LIMIT )
+	{
+		std::vector<u8> composite( limit / 2 + 1, 0 );
+
+		for ( u64 i = 1; ( 2 * i + 1 ) * ( 2 * i + 1 ) <= limit; ++i )
+		{
+			if ( composite[ i ] )
+				continue;
+
+			u64 p = 2 * i + 1;
+
+			for ( u64 j = ( p * p ) / 2; j <= limit / 2; j += p )
+				composite[ j ] = 1;
+		}
+
+		for ( u64 i = 1; i <= limit / 2; ++i )
+			if ( !composite[ i ] )
+				primes.push_back( static_cast<u32>( 2 * i + 1 ) );
+
+		return;
+	}
+
+	// Otherwise segment it with the wheel, the sieving primes for that only need to reach sqrt( limit )
+	WheelSieve sieve;
+	sieve_initialise( &sieve, 3, static_cast<u64>( limit ) + 1, DEFAULT_SIEVE_SEGMENT_BYTES );
+
+	std::vector<u64> found( sieve_segment_capacity( &sieve ) );
+
+	while ( !sieve_finished( &sieve ) )
+	{
+		u64 count = sieve_next_segment( &sieve, found.data() );
+
+		for ( u64 i = 0; i < count; ++i )
+			primes.push_back( static_cast<u32>( found[ i ] ) );
+	}
+}
+
+void sieving_primes_begin( SievingPrimes *sievingPrimes, u64 limit )
+{
+	sievingPrimes->limit = limit;
+	sievingPrimes->low = 3;
+	sievingPrimes->baseCount = 0;
+	sievingPrimes->multiples.clear();
+	sievingPrimes->primes.clear();
+	sievingPrimes->next = 0;
+}
+
+/// @desc Sieves blocks until one has primes in it or limit is passed
+static void sieving_primes_refill( SievingPrimes *sievingPrimes )
+{
+	sievingPrimes->primes.clear();
+	sievingPrimes->next = 0;
+
+	while ( sievingPrimes->primes.empty() && sievingPrimes->low <= sievingPrimes->limit )
+	{
+		u64 low = sievingPrimes->low;
+		u64 remaining = ( sievingPrimes->limit - low ) / 2 + 1;
+		u64 bytes = remaining < SIEVING_PRIMES_BLOCK_BYTES ? remaining : SIEVING_PRIMES_BLOCK_BYTES;
+		u64 last = low + 2 * ( bytes - 1 );
+
+		sievingPrimes->block.assign( bytes, 0 );
+		u8 *block = sievingPrimes->block.data();
+
+		// The squares of the small primes come in order, each is first reached in a block at or after low
+		while ( sievingPrimes->baseCount < SMALL_PRIMES.COUNT )
+		{
+			u64 p = SMALL_PRIMES.primes[ sievingPrimes->baseCount ];
+
+			if ( p * p > last )
+				break;
+
+			sievingPrimes->multiples.push_back( static_cast<u32>( ( p * p - low ) / 2 ) );
+			++sievingPrimes->baseCount;
+		}
+
+		for ( u32 i = 0; i < sievingPrimes->baseCount; ++i )
+		{
+			u64 p = SMALL_PRIMES.primes[ i ];
+			u64 j = sievingPrimes->multiples[ i ];
+
+			for ( ; j < bytes; j += p )
+				block[ j ] = 1;
+
+			sievingPrimes->multiples[ i ] = static_cast<u32>( j - bytes );
+		}
+
+		for ( u64 i = 0; i < bytes; ++i )
+			if ( !block[ i ] )
+				sievingPrimes->primes.push_back( static_cast<u32>( low + 2 * i ) );
+
+		sievingPrimes->low = low + 2 * bytes;
+	}
+}
+
+[[nodiscard]] inline u64 sieving_primes_peek( SievingPrimes *sievingPrimes )
+{
+	if ( sievingPrimes->next == sievingPrimes->primes.size() )
+		sieving_primes_refill( sievingPrimes );
+
+	return sievingPrimes->next < sievingPrimes->primes.size() ? sievingPrimes->primes[ sievingPrimes->next ] : 0;
+}
+
+inline void sieving_primes_pop( SievingPrimes *sievingPrimes )
+{
+	++sievingPrimes->next;
+}
+
+bool sieve_initialise( Sieve *sieve, u64 from, u64 to, u64 segmentBytes )
+{
+	if ( segmentBytes == 0 || segmentBytes > SIEVE_MAX_SEGMENT_BYTES )
+	{
+		show_log_warning( "Sieve segment size must be between 1 and %llu.", SIEVE_MAX_SEGMENT_BYTES );
+		return false;
+	}
+
+	sieve->high = to;
+	sieve->segmentBytes = segmentBytes;
+	sieve->includesTwo = ( from <= 2 && to > 2 );
+	sieve->low = ( from < 3 ) ? 3 : ( from | 1 );
+	sieve->activePrimes.clear();
+	sieve->multiples.clear();
+
+	if ( sieve->low >= to )
+	{
+		sieve->low = to;
+		sieving_primes_begin( &sieve->sievingPrimes, 0 );
+		return true;
+	}
+
+	sieving_primes_begin( &sieve->sievingPrimes, integer_sqrt( to - 1 ) );
+	sieve->segment.resize( segmentBytes );
+
+	return true;
+}
+
+[[nodiscard]] inline bool sieve_finished( const Sieve *sieve )
+{
+	return !sieve->includesTwo && sieve->low >= sieve->high;
+}
+
+[[nodiscard]] inline u64 sieve_segment_capacity( const Sieve *sieve )
+{
+	return sieve->segmentBytes + 1;
+}
+
+u64 sieve_next_segment( Sieve *sieve, u64 *primes )
+{
+	u64 count = 0;
+
+	if ( sieve->includesTwo )
+	{
+		primes[ count++ ] = 2;
+		sieve->includesTwo = false;
+	}
+
+	if ( sieve->low >= sieve->high )
+		return count;
+
+	u64 low = sieve->low;
+	u64 remaining = ( sieve->high - low + 1 ) / 2;
+	u64 bytes = remaining < sieve->segmentBytes ? remaining : sieve->segmentBytes;
+	u64 last = low + 2 * ( bytes - 1 );
+	u8 *segment = sieve->segment.data();
+
+	memset( segment, 0, bytes );
+
+	// Activate the sieving primes whose square falls in this segment
+	for ( u64 p = sieving_primes_peek( &sieve->sievingPrimes ); p && p * p <= last; p = sieving_primes_peek( &sieve->sievingPrimes ) )
+	{
+		u64 square = p * p;
+		u64 distance;
+
+		if ( square >= low )
+		{
+			distance = square - low;
+		}
+		else
+		{
+			// Distance to the next odd multiple (low is odd, so an odd distance lands on an even multiple)
+			distance = ( p - low % p ) % p;
+			if ( distance & 1 )
+				distance += p;
+		}
+
+		sieving_primes_pop( &sieve->sievingPrimes );
+
+		// Nothing to cross off, as for most of the large primes of a short range
+		if ( distance >= sieve->high - low )
+			continue;
+
+		sieve->activePrimes.push_back( static_cast<u32>( p ) );
+		sieve->multiples.push_back( distance / 2 );
+	}
+
+	const u32 *activePrimes = sieve->activePrimes.data();
+	u64 *multiples = sieve->multiples.data();
+
+	// Cross off, the stride between odd multiples is p segment entries
+	for ( u64 i = 0, activeCount = sieve->activePrimes.size(); i < activeCount; ++i )
+	{
+		u64 p = activePrimes[ i ];
+		u64 j = multiples[ i ];
+
+		for ( ; j < bytes; j += p )
+			segment[ j ] = 1;
+
+		multiples[ i ] = j - bytes;
+	}
+
+	for ( u64 i = 0; i < bytes; ++i )
+		if ( !segment[ i ] )
+			primes[ count++ ] = low + 2 * i;
+
+	// Avoid overflowing when the range ends at the top of u64
+	sieve->low = ( bytes == remaining ) ? sieve->high : low + 2 * bytes;
+
+	return count;
+}
+
+template <typename SieveType, SieveChunkMode Mode>
+static void sieve_parallel_worker( SieveParallel *parallel )
+{
+	SieveType sieve;
+	SieveType doubled;						// 2p + 1 of Sophie Germain tuples
+	std::vector<u64> found;
+	u64 slotCount = parallel->slots.size();
+
+	while ( true )
+	{
+		u64 chunkIndex;
+
+		{
+			std::unique_lock<std::mutex> lock( parallel->mutex );
+
+			chunkIndex = parallel->nextChunk++;
+
+			if ( chunkIndex >= parallel->chunkCount )
+				return;
+
+			// Don't run further ahead of the output than there are slots
+			parallel->slotFree.wait( lock, [&] { return chunkIndex < parallel->nextOutput + slotCount; } );
+		}
+
+		// The slot belongs to this worker until it is marked ready
+		SieveChunk &chunk = parallel->slots[ chunkIndex % slotCount ];
+
+		chunk.from = parallel->from + chunkIndex * parallel->chunkSpan;
+		chunk.to = ( chunkIndex == parallel->chunkCount - 1 ) ? parallel->to : chunk.from + parallel->chunkSpan;
+		chunk.primes.clear();
+		chunk.bits.clear();
+		chunk.count = 0;
+
+		if constexpr ( Mode == SIEVE_CHUNK_BITS )
+		{
+			sieve_initialise( &sieve, chunk.from, chunk.to, parallel->segmentBytes );
+
+			while ( !sieve_finished( &sieve ) )
+			{
+				const u8 *bits;
+				u64 bytes = sieve_next_segment_bits( &sieve, &bits );
+				chunk.bits.insert( chunk.bits.end(), bits, bits + bytes );
+				chunk.count += count_set_bits( bits, bytes );
+			}
+		}
+		else if constexpr ( Mode == SIEVE_CHUNK_TUPLES )
+		{
+			// A byte past the chunk for the tuples ending in the next one, and the doubled range in step with it
+			u64 end = prime_tuple_sieve_end( chunk.to );
+			bool sophieGermain = ( parallel->tuple == PRIME_TUPLE_SOPHIE_GERMAIN );
+
+			sieve_initialise( &sieve, chunk.from, end, parallel->segmentBytes );
+			if ( sophieGermain )
+				sieve_initialise( &doubled, 2 * chunk.from, 2 * end, 2 * parallel->segmentBytes );
+
+			if ( chunk.from == 0 )
+				prime_tuple_small( parallel->tuple, chunk.to, chunk.primes );
+
+			// The last byte of each segment waits for the first of the next one
+			u64 byte = chunk.from / 30;
+			u8 held[ 2 ] = {};
+			u8 heldDoubled[ 2 ] = {};
+			bool holding = false;
+
+			while ( !sieve_finished( &sieve ) )
+			{
+				const u8 *bits;
+				const u8 *doubledBits = nullptr;
+				u64 bytes = sieve_next_segment_bits( &sieve, &bits );
+
+				if ( sophieGermain )
+					sieve_next_segment_bits( &doubled, &doubledBits );
+
+				if ( holding )
+				{
+					held[ 1 ] = bits[ 0 ];
+					prime_tuple_scan( parallel->tuple, byte - 1, held, 1, heldDoubled, chunk.to, chunk.primes );
+				}
+
+				prime_tuple_scan( parallel->tuple, byte, bits, bytes - 1, doubledBits, chunk.to, chunk.primes );
+
+				held[ 0 ] = bits[ bytes - 1 ];
+				if ( sophieGermain )
+					memcpy( heldDoubled, doubledBits + 2 * ( bytes - 1 ), 2 );
+
+				holding = true;
+				byte += bytes;
+			}
+
+			chunk.count = chunk.primes.size();
+		}
+		else
+		{
+			sieve_initialise( &sieve, chunk.from, chunk.to, parallel->segmentBytes );
+			found.resize( sieve_segment_capacity( &sieve ) );
+
+			if ( parallel->statistics )
+				prime_stats_begin( &chunk.stats, chunk.from );
+
+			while ( !sieve_finished( &sieve ) )
+			{
+				u64 count = sieve_next_segment( &sieve, found.data() );
+				chunk.primes.insert( chunk.primes.end(), found.data(), found.data() + count );
+
+				// While the segment is still in cache
+				if ( parallel->statistics )
+					prime_stats_add( &chunk.stats, found.data(), count );
+			}
+
+			if ( parallel->statistics )
+				prime_stats_end( &chunk.stats, chunk.to );
+
+			chunk.count = chunk.primes.size();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock( parallel->mutex );
+			parallel->slotReady[ chunkIndex % slotCount ] = 1;
+		}
+
+		parallel->chunkReady.notify_all();
+	}
+}
+
+template <typename SieveType, SieveChunkMode Mode, typename Output>
+static bool sieve_parallel_run( u64 from, u64 to, u64 segmentBytes, u32 threadCount, u64 *found, Output output, PrimeStats *stats, PrimeTuple tuple = PRIME_TUPLE_COUNT )
+{
+	*found = 0;
+
+	// The chunks only differ in their ranges, a segment size one of them can't take none of them can, so it is tried
+	// on an empty range before any worker starts
+	SieveType probe;
+
+	if ( !sieve_initialise( &probe, from, from, segmentBytes ) )
+		return false;
+
+	if ( Mode == SIEVE_CHUNK_TUPLES && tuple == PRIME_TUPLE_SOPHIE_GERMAIN && !sieve_initialise( &probe, 2 * from, 2 * from, 2 * segmentBytes ) )
+		return false;
+
+	if ( from >= to )
+		return true;
+
+	if ( threadCount == 0 )
+		threadCount = 1;
+
+	SieveParallel parallel;
+	parallel.from = from;
+	parallel.to = to;
+	parallel.segmentBytes = segmentBytes;
+
+	// Chunks come from a fixed budget rather than a count of segments, so a bigger segment doesn't grow every slot
+	// with it. Whole segments while they fit in the budget.
+	u64 chunkBytes = ( segmentBytes < SIEVE_CHUNK_BYTES ) ? SIEVE_CHUNK_BYTES - SIEVE_CHUNK_BYTES % segmentBytes : SIEVE_CHUNK_BYTES;
+	parallel.chunkSpan = SieveType::INTEGERS_PER_BYTE * chunkBytes;
+
+	// Every chunk has to place each sieving prime again, keep that small next to the sieving itself. Not so far that
+	// a window ends up with fewer chunks than threads though, each worker then places them once for its share.
+	u64 placementSpan = integer_sqrt( to );
+	u64 threadSpan = ( to - from ) / threadCount + 1;
+
+	if ( placementSpan > threadSpan )
+		placementSpan = threadSpan;
+
+	if ( parallel.chunkSpan < placementSpan )
+		parallel.chunkSpan = placementSpan;
+
+	// Chunks have to start on a byte of the sieve
+	parallel.chunkSpan += ( SieveType::INTEGERS_PER_BYTE - parallel.chunkSpan % SieveType::INTEGERS_PER_BYTE ) % SieveType::INTEGERS_PER_BYTE;
+
+	parallel.chunkCount = ( to - from ) / parallel.chunkSpan + ( ( to - from ) % parallel.chunkSpan != 0 );
+
+	// Workers without a chunk to claim would only hold slots
+	if ( threadCount > parallel.chunkCount )
+		threadCount = static_cast<u32>( parallel.chunkCount );
+	parallel.nextChunk = 0;
+	parallel.nextOutput = 0;
+	parallel.statistics = ( stats != nullptr );
+	parallel.tuple = tuple;
+	parallel.slots.resize( static_cast<u64>( threadCount ) * 2 );
+	parallel.slotReady.assign( parallel.slots.size(), 0 );
+
+	std::vector<std::thread> workers;
+	workers.reserve( threadCount );
+
+	for ( u32 i = 0; i < threadCount; ++i )
+		workers.emplace_back( sieve_parallel_worker<SieveType, Mode>, &parallel );
+
+	u64 primesFound = 0;
+	u64 slotCount = parallel.slots.size();
+
+	for ( u64 chunkIndex = 0; chunkIndex < parallel.chunkCount; ++chunkIndex )
+	{
+		u64 slot = chunkIndex % slotCount;
+
+		{
+			std::unique_lock<std::mutex> lock( parallel.mutex );
+			parallel.chunkReady.wait( lock, [&] { return parallel.slotReady[ slot ] != 0; } );
+		}
+
+		output( static_cast<const SieveChunk &>( parallel.slots[ slot ] ) );
+		primesFound += parallel.slots[ slot ].count;
+
+		if ( stats )
+			prime_stats_merge( stats, &parallel.slots[ slot ].stats );
+
+		{
+			std::lock_guard<std::mutex> lock( parallel.mutex );
+			parallel.slotReady[ slot ] = 0;
+			++parallel.nextOutput;
+		}
+
+		parallel.slotFree.notify_all();
+	}
+
+	for ( std::thread &worker : workers )
+		worker.join();
+
+	*found = primesFound;
+
+	return true;
+}
+
+template <typename SieveType, typename Output>
+bool sieve_parallel( u64 from, u64 to, u64 segmentBytes, u32 threadCount, u64 *found, Output output, PrimeStats *stats )
+{
+	return sieve_parallel_run<SieveType, SIEVE_CHUNK_PRIMES>( from, to, segmentBytes, threadCount, found, output, stats );
+}
+
+template <typename Output>
+bool sieve_parallel_bitmap( u64 from, u64 to, u64 segmentBytes, u32 threadCount, u64 *found, Output output )
+{
+	return sieve_parallel_run<WheelSieve, SIEVE_CHUNK_BITS>( from, to, segmentBytes, threadCount, found, output, nullptr );
+}
+
+template <typename Output>
+bool sieve_parallel_tuples( u64 from, u64 to, PrimeTuple tuple, u64 segmentBytes, u32 threadCount, u64 *found, Output output )
+{
+	return sieve_parallel_run<WheelSieve, SIEVE_CHUNK_TUPLES>( from, to, segmentBytes, threadCount, found, output, nullptr, tuple );
+}
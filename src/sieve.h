@@ -0,0 +1,118 @@
+#pragma once
+
+using SieveEngine = u32;
+enum SIEVE_ENGINE : SieveEngine
+{
+	SIEVE_ENGINE_ODD,						// one byte per odd number
+	SIEVE_ENGINE_WHEEL,						// mod 30 wheel, one bit per number coprime to 30
+};
+
+// Sieving primes.
+// The odd primes up to the square root of a range, sieved a block at a time from SMALL_PRIMES as a sieve reaches
+// their squares. A sieve only keeps the ones it still has multiples to cross off, never the whole list.
+#define SIEVING_PRIMES_BLOCK_BYTES					( KB( 64 ) )		// odd numbers per block
+
+struct SievingPrimes
+{
+	u64 limit;								// last number looked at, at most UINT32_MAX
+	u64 low;								// first (odd) number of the next block
+	u32 baseCount;							// SMALL_PRIMES sieving the blocks so far
+	std::vector<u32> multiples;				// block index of the next odd multiple of each of them
+	std::vector<u8> block;					// 1 = composite
+	std::vector<u32> primes;				// of the last block
+	u64 next;								// entry of primes handed out next
+};
+
+/// @desc Starts handing out the odd primes up to limit
+void sieving_primes_begin( SievingPrimes *sievingPrimes, u64 limit );
+/// @desc The next prime without moving past it, 0 once they have all been handed out
+[[nodiscard]] inline u64 sieving_primes_peek( SievingPrimes *sievingPrimes );
+inline void sieving_primes_pop( SievingPrimes *sievingPrimes );
+
+// Segmented sieve of Eratosthenes.
+// Only odd numbers are stored (one byte each), so a segment of N bytes covers 2N integers.
+#define SIEVE_MAX_SEGMENT_BYTES						( 1ull << 28 )		// the primes found in a segment take 8 times this
+
+struct Sieve
+{
+	static constexpr SieveEngine ENGINE = SIEVE_ENGINE_ODD;
+	static constexpr u64 INTEGERS_PER_BYTE = 2;
+
+	u64 low;								// first (odd) number of the next segment
+	u64 high;								// end of the range (exclusive)
+	u64 segmentBytes;						// odd numbers sieved per segment
+	bool includesTwo;						// 2 is inside the range (it is never in a segment)
+	std::vector<u8> segment;				// 1 = composite
+	SievingPrimes sievingPrimes;			// odd primes up to sqrt( high ) whose square has not been reached
+	std::vector<u32> activePrimes;			// sieving primes with a multiple left in the range
+	std::vector<u64> multiples;				// segment index of the next odd multiple of each active sieving prime
+};
+
+void sieve_small_primes( u32 limit, std::vector<u32> &primes );
+
+/// @desc Prepares to sieve [from, to)
+bool sieve_initialise( Sieve *sieve, u64 from, u64 to, u64 segmentBytes );
+[[nodiscard]] inline bool sieve_finished( const Sieve *sieve );
+[[nodiscard]] inline u64 sieve_segment_capacity( const Sieve *sieve );
+
+/// @desc Sieves the next segment and writes the primes found into primes (needs room for sieve_segment_capacity values)
+/// @return Number of primes written
+u64 sieve_next_segment( Sieve *sieve, u64 *primes );
+
+// Parallel sieve
+// The range is split into chunks of SIEVE_CHUNK_BYTES that workers claim in order. A bounded ring of
+// chunk slots lets the calling thread hand each chunk to the output in ascending order. Chunks grow towards
+// sqrt( to ) when placing the sieving primes would cost more than sieving, but always number at least one per thread.
+using SieveChunkMode = u32;
+enum SIEVE_CHUNK_MODE : SieveChunkMode
+{
+	SIEVE_CHUNK_PRIMES,						// the primes
+	SIEVE_CHUNK_BITS,						// the wheel bytes
+	SIEVE_CHUNK_TUPLES,						// the first member of each tuple
+};
+
+struct SieveChunk
+{
+	u64 from;
+	u64 to;
+	u64 count;								// primes (or tuples) in [from, to)
+	std::vector<u64> primes;				// or the first members of the tuples, for sieve_parallel_tuples
+	std::vector<u8> bits;					// wheel bytes of [from, to) instead of primes, for sieve_parallel_bitmap
+	PrimeStats stats;						// of [from, to), when sieve_parallel was asked for them
+};
+
+struct SieveParallel
+{
+	std::mutex mutex;
+	std::condition_variable chunkReady;
+	std::condition_variable slotFree;
+	u64 from;
+	u64 to;
+	u64 segmentBytes;
+	u64 chunkSpan;							// integers per chunk
+	u64 chunkCount;
+	u64 nextChunk;							// next chunk to be claimed by a worker
+	u64 nextOutput;							// next chunk to be handed to the output
+	bool statistics;						// tally the primes of each chunk
+	PrimeTuple tuple;						// tuple looked for by sieve_parallel_tuples
+	std::vector<SieveChunk> slots;
+	std::vector<u8> slotReady;
+};
+
+/// @desc Sieves [from, to) across threadCount workers with the SieveType engine, output( const SieveChunk & ) receives each chunk in ascending order
+/// and the number of primes found is written to found.
+/// Pass stats to have each worker tally its chunks as it sieves them, they are merged into stats in order.
+/// @return false when the engine can't sieve segments of segmentBytes, output is never called then
+template <typename SieveType, typename Output>
+bool sieve_parallel( u64 from, u64 to, u64 segmentBytes, u32 threadCount, u64 *found, Output output, PrimeStats *stats = nullptr );
+
+/// @desc Sieves [from, to) like sieve_parallel with the wheel engine, but each chunk hands over its bits rather than its
+/// primes. from has to be a multiple of 30, and 2, 3 and 5 are left out as they have no bits.
+template <typename Output>
+bool sieve_parallel_bitmap( u64 from, u64 to, u64 segmentBytes, u32 threadCount, u64 *found, Output output );
+
+/// @desc Sieves [from, to) like sieve_parallel with the wheel engine, but each chunk hands over the first member of
+/// every tuple starting in it rather than its primes, found is the number of tuples. from has to be a multiple of 30.
+/// Sophie Germain tuples sieve 2p + 1 with segments of twice segmentBytes.
+template <typename Output>
+bool sieve_parallel_tuples( u64 from, u64 to, PrimeTuple tuple, u64 segmentBytes, u32 threadCount, u64 *found, Output output );
@@ -0,0 +1,183 @@
+void sieve_tuning_from_caches( SieveTuning *tuning, const CacheSizes *caches )
+{
+	auto clamp_segment = [] ( u64 bytes )
+		{
+			// Powers of two keep the segments lined up with the chunks of the parallel sieve
+			u64 segment = SIEVE_TUNING_MIN_SEGMENT;
+
+			while ( segment * 2 <= bytes && segment < SIEVE_TUNING_MAX_SEGMENT )
+				segment *= 2;
+
+			return segment;
+		};
+
+	u64 l1 = caches->l1Data ? caches->l1Data : DEFAULT_SIEVE_SEGMENT_BYTES;
+	u64 l2 = caches->l2 ? caches->l2 : 8 * l1;
+
+	tuning->caches = *caches;
+	tuning->oddSegmentBytes = clamp_segment( l1 );
+	// A quarter of L2 leaves room for the bucket entries and the sieving primes streaming through it
+	tuning->wheelSegmentBytes = clamp_segment( l2 / 4 > l1 ? l2 / 4 : l1 );
+	tuning->calibrated = false;
+}
+
+/// @desc Ticks taken to sieve SIEVE_TUNING_CALIBRATION_BYTES of segments with segmentBytes, the best of a few runs
+template <typename SieveType>
+static u64 sieve_tuning_time( u64 segmentBytes )
+{
+	u64 from = SIEVE_TUNING_CALIBRATION_FROM;
+	u64 to = from + SieveType::INTEGERS_PER_BYTE * SIEVE_TUNING_CALIBRATION_BYTES;
+	u64 best = UINT64_MAX;
+
+	SieveType sieve;
+	std::vector<u64> primes;
+
+	for ( u32 run = 0; run < SIEVE_TUNING_CALIBRATION_RUNS; ++run )
+	{
+		u64 start = platform_get_tick_counter();
+
+		sieve_initialise( &sieve, from, to, segmentBytes );
+		primes.resize( sieve_segment_capacity( &sieve ) );
+
+		while ( !sieve_finished( &sieve ) )
+			sieve_next_segment( &sieve, primes.data() );
+
+		u64 ticks = platform_get_tick_counter() - start;
+
+		if ( ticks < best )
+			best = ticks;
+	}
+
+	return best;
+}
+
+template <typename SieveType>
+static u64 sieve_tuning_fastest( const CacheSizes *caches )
+{
+	u64 l1 = caches->l1Data ? caches->l1Data : DEFAULT_SIEVE_SEGMENT_BYTES;
+	u64 l2 = caches->l2 ? caches->l2 : 8 * l1;
+	u64 first = ( l1 / 2 > SIEVE_TUNING_MIN_SEGMENT ) ? l1 / 2 : SIEVE_TUNING_MIN_SEGMENT;
+	u64 last = ( l2 < SIEVE_TUNING_MAX_SEGMENT ) ? l2 : SIEVE_TUNING_MAX_SEGMENT;
+
+	u64 fastest = 0;
+	u64 fastestTicks = UINT64_MAX;
+
+	for ( u64 segmentBytes = first; segmentBytes <= last; segmentBytes *= 2 )
+	{
+		u64 ticks = sieve_tuning_time<SieveType>( segmentBytes );
+
+		verbose_log_message( "  %s segment of %llu bytes: %llu microseconds", ( SieveType::ENGINE == SIEVE_ENGINE_ODD ) ? "Odd" : "Wheel", segmentBytes,
+			ticks * 1000000 / platform_get_tick_frequency() );
+
+		if ( ticks < fastestTicks )
+		{
+			fastestTicks = ticks;
+			fastest = segmentBytes;
+		}
+	}
+
+	return fastest;
+}
+
+void sieve_tuning_calibrate( SieveTuning *tuning )
+{
+	tuning->oddSegmentBytes = sieve_tuning_fastest<Sieve>( &tuning->caches );
+	tuning->wheelSegmentBytes = sieve_tuning_fastest<WheelSieve>( &tuning->caches );
+	tuning->calibrated = true;
+}
+
+bool sieve_tuning_load( SieveTuning *tuning, const CacheSizes *caches, const char *path )
+{
+	if ( !platform_file_exists( path ) )
+		return false;
+
+	u32 file = platform_open_file( path, FILE_OPTION_READ );
+	if ( file == INVALID_FILE_INDEX )
+		return false;
+
+	std::vector<char> text( platform_get_file_size( file ) + 1, '\0' );
+	bool read = platform_read_from_file( file, text.data(), text.size() - 1 ) == text.size() - 1;
+
+	platform_close_file( file );
+
+	if ( !read )
+		return false;
+
+	SieveTuning loaded = {};
+	u64 version = 0;
+	u64 calibrated = 0;
+
+	// name value per line, unknown names are left for later versions
+	for ( char *line = strtok( text.data(), "\r\n" ); line; line = strtok( nullptr, "\r\n" ) )
+	{
+		char name[ 16 ];
+		u64 value;
+
+		if ( sscanf( line, "%15s %llu", name, &value ) != 2 )
+			continue;
+
+		if ( string_utf8_compare( name, "version" ) )		version = value;
+		else if ( string_utf8_compare( name, "l1" ) )		loaded.caches.l1Data = value;
+		else if ( string_utf8_compare( name, "l2" ) )		loaded.caches.l2 = value;
+		else if ( string_utf8_compare( name, "l3" ) )		loaded.caches.l3 = value;
+		else if ( string_utf8_compare( name, "odd" ) )		loaded.oddSegmentBytes = value;
+		else if ( string_utf8_compare( name, "wheel" ) )	loaded.wheelSegmentBytes = value;
+		else if ( string_utf8_compare( name, "calibrated" ) )	calibrated = value;
+	}
+
+	// A working directory shared across machines only keeps sizes for the processor that made them
+	if ( version != SIEVE_TUNING_VERSION || loaded.caches.l1Data != caches->l1Data || loaded.caches.l2 != caches->l2 || loaded.caches.l3 != caches->l3 )
+		return false;
+
+	// Held to the limits of -segment, the wheel size has to do for the Sophie Germain tuples as well
+	if ( loaded.oddSegmentBytes < sieve_min_segment_bytes( SIEVE_ENGINE_ODD ) || loaded.oddSegmentBytes > sieve_max_segment_bytes( SIEVE_ENGINE_ODD ) ||
+		loaded.wheelSegmentBytes < sieve_min_segment_bytes( SIEVE_ENGINE_WHEEL ) || loaded.wheelSegmentBytes > sieve_max_segment_bytes( SIEVE_ENGINE_WHEEL, true ) )
+	{
+		show_log_warning( "Ignoring the segment sizes of %s, they are out of range.", path );
+		return false;
+	}
+
+	loaded.calibrated = ( calibrated != 0 );
+	*tuning = loaded;
+
+	return true;
+}
+
+bool sieve_tuning_save( const SieveTuning *tuning, const char *path )
+{
+	u32 file = platform_open_file( path, FILE_OPTION_CREATE | FILE_OPTION_WRITE | FILE_OPTION_CLEAR );
+	if ( file == INVALID_FILE_INDEX )
+		return false;
+
+	bool written = true;
+
+	write_file_line( file, &written, "version %u\n", SIEVE_TUNING_VERSION );
+	write_file_line( file, &written, "l1 %llu\n", tuning->caches.l1Data );
+	write_file_line( file, &written, "l2 %llu\n", tuning->caches.l2 );
+	write_file_line( file, &written, "l3 %llu\n", tuning->caches.l3 );
+	write_file_line( file, &written, "odd %llu\n", tuning->oddSegmentBytes );
+	write_file_line( file, &written, "wheel %llu\n", tuning->wheelSegmentBytes );
+	write_file_line( file, &written, "calibrated %u\n", tuning->calibrated ? 1 : 0 );
+
+	platform_close_file( file );
+
+	return written;
+}
+
+[[nodiscard]] inline u64 sieve_tuning_segment_bytes( const SieveTuning *tuning, SieveEngine engine )
+{
+	return ( engine == SIEVE_ENGINE_ODD ) ? tuning->oddSegmentBytes : tuning->wheelSegmentBytes;
+}
+
+[[nodiscard]] inline u64 sieve_min_segment_bytes( SieveEngine engine )
+{
+	return ( engine == SIEVE_ENGINE_ODD ) ? 1 : WHEEL_MIN_SEGMENT_BYTES;
+}
+
+[[nodiscard]] inline u64 sieve_max_segment_bytes( SieveEngine engine, bool doubled )
+{
+	if ( engine == SIEVE_ENGINE_ODD )
+		return SIEVE_MAX_SEGMENT_BYTES;
+
+	return doubled ? WHEEL_MAX_SEGMENT_BYTES / 2 : WHEEL_MAX_SEGMENT_BYTES;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Segment sizes for the sieve engines, picked from the cache sizes of the processor and optionally by timing a
+// short sieve with each candidate. The odd sieve touches its whole segment for every sieving prime, so it wants
+// the segment in L1. The wheel sieve covers 30 integers a byte and hands primes of at least 30 * segmentBytes to
+// its buckets, so a bigger segment (towards L2) means fewer bucket trips for the large primes.
+// The wheel's bucket pages follow from its segment size (wheel_bucket_page_entries), so timing a segment size
+// times its pages with it.
+// The result is kept in SIEVE_TUNING_FILE in the working directory and reused while the caches match it, a
+// different processor works it out again.
+#define SIEVE_TUNING_VERSION					( 1 )
+#define SIEVE_TUNING_MIN_SEGMENT				( KB( 8 ) )
+#define SIEVE_TUNING_MAX_SEGMENT				( MB( 4 ) )
+#define SIEVE_TUNING_CALIBRATION_FROM			( 10000000000ull )	// where big tables spend most of their time
+#define SIEVE_TUNING_CALIBRATION_BYTES			( MB( 2 ) )				// segment bytes sieved per candidate
+#define SIEVE_TUNING_CALIBRATION_RUNS			( 3 )					// best of
+
+struct SieveTuning
+{
+	CacheSizes caches;						// what the sizes were picked for
+	u64 oddSegmentBytes;
+	u64 wheelSegmentBytes;
+	bool calibrated;						// timed rather than guessed from the caches
+};
+
+/// @desc Sizes from the caches alone
+void sieve_tuning_from_caches( SieveTuning *tuning, const CacheSizes *caches );
+/// @desc Times a short sieve with each segment size from half of L1 to L2 for both engines and keeps the fastest
+void sieve_tuning_calibrate( SieveTuning *tuning );
+
+/// @desc Loads the tuning at path if it was made for these caches
+bool sieve_tuning_load( SieveTuning *tuning, const CacheSizes *caches, const char *path );
+bool sieve_tuning_save( const SieveTuning *tuning, const char *path );
+
+[[nodiscard]] inline u64 sieve_tuning_segment_bytes( const SieveTuning *tuning, SieveEngine engine );
+
+/// @desc Segment sizes the engine can sieve with, doubled for the wheel sieving 2p + 1 of Sophie Germain tuples at
+/// twice the size
+[[nodiscard]] inline u64 sieve_min_segment_bytes( SieveEngine engine );
+[[nodiscard]] inline u64 sieve_max_segment_bytes( SieveEngine engine, bool doubled = false );
@@ -0,0 +1,408 @@
+static constexpr WheelTable<30> WHEEL = wheel_table<30>();
+static constexpr const u8 ( &WHEEL_OFFSETS )[ 8 ] = WHEEL.offsets;		// 1, 7, 11, 13, 17, 19, 23, 29
+static constexpr const u8 ( &WHEEL_STEPS )[ 8 ] = WHEEL.steps;
+
+static_assert( WHEEL.SIZE == 8, "A byte holds the residues of 30 integers." );
+
+// Crossing off p * m for p and m both coprime to 30, indexed by [ wheel index of p ][ wheel index of m ]
+struct WheelCrossTables
+{
+	u8 crossMask[ 8 ][ 8 ];					// bit holding the multiple
+	u8 carry[ 8 ][ 8 ];						// extra bytes moved when stepping to the next multiplier
+};
+
+static consteval WheelCrossTables wheel_cross_tables()
+{
+	WheelCrossTables t = {};
+
+	for ( u32 residue = 0; residue < 8; ++residue )
+	{
+		for ( u32 wheel = 0; wheel < 8; ++wheel )
+		{
+			u32 product = WHEEL_OFFSETS[ residue ] * WHEEL_OFFSETS[ wheel ];
+			t.crossMask[ residue ][ wheel ] = static_cast<u8>( BIT( WHEEL.index[ product % 30 ] ) );
+			t.carry[ residue ][ wheel ] = static_cast<u8>( ( product % 30 + WHEEL_OFFSETS[ residue ] * WHEEL_STEPS[ wheel ] ) / 30 );
+		}
+	}
+
+	return t;
+}
+
+static constexpr WheelCrossTables WHEEL_CROSS = wheel_cross_tables();
+
+/// @desc WHEEL_PRESIEVE_BYTES with the multiples of 7 - 19 cleared, too big to be worth building at compile time
+static const std::vector<u8> &wheel_presieve()
+{
+	static const std::vector<u8> presieve = [] ()
+		{
+			std::vector<u8> bytes( WHEEL_PRESIEVE_BYTES, 0xFF );
+
+			for ( u64 p : { 7, 11, 13, 17, 19 } )
+			{
+				for ( u64 value = p; value < 30 * WHEEL_PRESIEVE_BYTES; value += 2 * p )
+				{
+					u8 bit = WHEEL.index[ value % 30 ];
+					if ( bit != 0xFF )
+						bytes[ value / 30 ] &= static_cast<u8>( ~BIT( bit ) );
+				}
+			}
+
+			return bytes;
+		}();
+
+	return presieve;
+}
+
+bool sieve_initialise( WheelSieve *sieve, u64 from, u64 to, u64 segmentBytes )
+{
+	if ( segmentBytes < WHEEL_MIN_SEGMENT_BYTES || segmentBytes > WHEEL_MAX_SEGMENT_BYTES )
+	{
+		show_log_warning( "Wheel sieve segment size must be between %llu and %llu.", WHEEL_MIN_SEGMENT_BYTES, WHEEL_MAX_SEGMENT_BYTES );
+		return false;
+	}
+
+	sieve->from = from;
+	sieve->to = to;
+	sieve->segmentBytes = segmentBytes;
+	sieve->smallPrimesPending = ( from < 6 && to > 2 );
+	sieve->activePrimes.clear();
+	sieve->segmentNumber = 0;
+	sieve->bucketMask = 0;
+
+	// Pages are kept for the next range while they are the same size
+	u32 pageEntries = wheel_bucket_page_entries( segmentBytes );
+
+	if ( sieve->bucketPageEntries != pageEntries )
+	{
+		sieve->bucketPages.clear();
+		sieve->bucketPageEntries = pageEntries;
+	}
+
+	sieve->buckets.clear();
+	sieve->freePage = WHEEL_BUCKET_NO_PAGE;
+
+	for ( u32 page = 0; page < sieve->bucketPages.size(); ++page )
+	{
+		sieve->bucketPages[ page ].next = sieve->freePage;
+		sieve->freePage = page;
+	}
+
+	if ( from >= to )
+	{
+		sieve->lowByte = 0;
+		sieve->highByte = 0;
+		sieving_primes_begin( &sieve->sievingPrimes, 0 );
+		return true;
+	}
+
+	sieve->lowByte = from / 30;
+	sieve->highByte = ( to - 1 ) / 30 + 1;
+	sieve->lastSegment = ( sieve->highByte - 1 - sieve->lowByte ) / segmentBytes;
+
+	sieving_primes_begin( &sieve->sievingPrimes, integer_sqrt( to - 1 ) );
+
+	// 3 and 5 are part of the wheel, 7 - 19 are in the pre-sieve pattern
+	for ( u64 p = sieving_primes_peek( &sieve->sievingPrimes ); p && p < WHEEL_FIRST_SIEVING_PRIME; p = sieving_primes_peek( &sieve->sievingPrimes ) )
+		sieving_primes_pop( &sieve->sievingPrimes );
+
+	sieve->segment.resize( segmentBytes );
+
+	// Enough buckets to file the furthest multiple of the largest sieving prime (a first multiple is under 7p away)
+	u64 largest = integer_sqrt( to - 1 );
+
+	if ( largest >= 30 * segmentBytes )
+	{
+		u64 segmentsAhead = ( segmentBytes + ( 7 * largest ) / 30 + 7 ) / segmentBytes + 2;
+		u64 bucketCount = 1;
+
+		while ( bucketCount < segmentsAhead )
+			bucketCount <<= 1;
+
+		sieve->buckets.assign( bucketCount, WHEEL_BUCKET_NO_PAGE );
+
+		sieve->bucketMask = bucketCount - 1;
+	}
+
+	return true;
+}
+
+[[nodiscard]] inline bool sieve_finished( const WheelSieve *sieve )
+{
+	return !sieve->smallPrimesPending && sieve->lowByte >= sieve->highByte;
+}
+
+[[nodiscard]] inline u64 sieve_segment_capacity( const WheelSieve *sieve )
+{
+	return 8 * sieve->segmentBytes + 3;
+}
+
+[[nodiscard]] inline u32 wheel_bucket_page_entries( u64 segmentBytes )
+{
+	// The pages partly filled are about one per bucket, a page of segmentBytes / 64 entries keeps them a small
+	// share of the entries whatever the segment size
+	u64 entries = segmentBytes / 64;
+
+	if ( entries < WHEEL_BUCKET_PAGE_MIN_ENTRIES )
+		return WHEEL_BUCKET_PAGE_MIN_ENTRIES;
+
+	return entries < WHEEL_BUCKET_PAGE_MAX_ENTRIES ? static_cast<u32>( entries ) : WHEEL_BUCKET_PAGE_MAX_ENTRIES;
+}
+
+static void wheel_sieve_file_bucket( WheelSieve *sieve, u32 prime, u64 index, u8 wheel )
+{
+	// index is relative to the current segment
+	u64 segment = sieve->segmentNumber + index / sieve->segmentBytes;
+
+	// Past the end of the range, nothing left to cross off
+	if ( segment > sieve->lastSegment )
+		return;
+
+	WheelBucketEntry entry;
+	entry.prime = prime;
+	entry.index = static_cast<u32>( ( index % sieve->segmentBytes ) << 3 | wheel );
+
+	u32 &bucket = sieve->buckets[ segment & sieve->bucketMask ];
+
+	// A new page in front once the newest is full
+	if ( bucket == WHEEL_BUCKET_NO_PAGE || sieve->bucketPages[ bucket ].count == sieve->bucketPageEntries )
+	{
+		u32 page = sieve->freePage;
+
+		if ( page != WHEEL_BUCKET_NO_PAGE )
+		{
+			sieve->freePage = sieve->bucketPages[ page ].next;
+		}
+		else
+		{
+			page = static_cast<u32>( sieve->bucketPages.size() );
+			sieve->bucketPages.emplace_back();
+			sieve->bucketPages.back().entries.resize( sieve->bucketPageEntries );
+		}
+
+		sieve->bucketPages[ page ].next = bucket;
+		sieve->bucketPages[ page ].count = 0;
+		bucket = page;
+	}
+
+	WheelBucketPage &page = sieve->bucketPages[ bucket ];
+	page.entries[ page.count++ ] = entry;
+}
+
+static void wheel_sieve_add_prime( WheelSieve *sieve, u64 p, u64 lowByte )
+{
+	// First multiple p * m >= max( p * p, segment start ) with m coprime to 30
+	u64 low = 30 * lowByte;
+	u64 m = p;
+
+	if ( p * p < low )
+		m = low / p + ( low % p != 0 );
+
+	u64 r = m % 30;
+	u8 wheel = 0;
+
+	while ( WHEEL_OFFSETS[ wheel ] < r )
+		++wheel;
+
+	m += WHEEL_OFFSETS[ wheel ] - r;
+
+	// p * m is under low + 30p, so it can only have wrapped past 2^64 by coming out below low. Either way there is no
+	// multiple left in the range, as for most of the large primes of a short range.
+	u64 multiple = p * m;
+
+	if ( multiple < low || multiple >= sieve->to )
+		return;
+
+	u64 quotient = p / 30;
+	u8 residue = WHEEL.index[ p % 30 ];
+	u64 index = multiple / 30 - lowByte;
+
+	if ( quotient >= sieve->segmentBytes )
+	{
+		wheel_sieve_file_bucket( sieve, static_cast<u32>( quotient << 3 | residue ), index, wheel );
+		return;
+	}
+
+	WheelSievingPrime sievingPrime;
+	sievingPrime.quotient = static_cast<u32>( quotient );
+	sievingPrime.residue = residue;
+	sievingPrime.wheel = wheel;
+	sievingPrime.index = index;
+
+	sieve->activePrimes.push_back( sievingPrime );
+}
+
+/// @desc Sieves the next segment into sieve->segment and moves on past it
+/// @return Bytes sieved
+static u64 wheel_sieve_segment( WheelSieve *sieve )
+{
+	const u8 *presieve = wheel_presieve().data();
+	u64 lowByte = sieve->lowByte;
+	u64 bytes = sieve->highByte - lowByte < sieve->segmentBytes ? sieve->highByte - lowByte : sieve->segmentBytes;
+	bool lastSegment = ( lowByte + bytes == sieve->highByte );
+	u64 last = lastSegment ? sieve->to - 1 : 30 * ( lowByte + bytes ) - 1;
+	u8 *segment = sieve->segment.data();
+
+	// Start from the pre-sieved pattern
+	u64 patternIndex = lowByte % WHEEL_PRESIEVE_BYTES;
+
+	for ( u64 copied = 0; copied < bytes; )
+	{
+		u64 run = bytes - copied < WHEEL_PRESIEVE_BYTES - patternIndex ? bytes - copied : WHEEL_PRESIEVE_BYTES - patternIndex;
+		memcpy( segment + copied, presieve + patternIndex, run );
+		copied += run;
+		patternIndex = 0;
+	}
+
+	// The pattern crossed off 7 - 19 themselves, and 1 is not prime
+	if ( lowByte == 0 )
+		segment[ 0 ] = ( segment[ 0 ] | 0b00111110 ) & 0b11111110;
+
+	// Activate the sieving primes whose square falls in this segment
+	for ( u64 p = sieving_primes_peek( &sieve->sievingPrimes ); p && p * p <= last; p = sieving_primes_peek( &sieve->sievingPrimes ) )
+	{
+		wheel_sieve_add_prime( sieve, p, lowByte );
+		sieving_primes_pop( &sieve->sievingPrimes );
+	}
+
+	// Cross off
+	for ( WheelSievingPrime &sievingPrime : sieve->activePrimes )
+	{
+		const u8 *crossMask = WHEEL_CROSS.crossMask[ sievingPrime.residue ];
+		const u8 *carry = WHEEL_CROSS.carry[ sievingPrime.residue ];
+		u64 quotient = sievingPrime.quotient;
+		u64 index = sievingPrime.index;
+		u8 wheel = sievingPrime.wheel;
+
+		while ( index < bytes )
+		{
+			segment[ index ] &= ~crossMask[ wheel ];
+			index += quotient * WHEEL_STEPS[ wheel ] + carry[ wheel ];
+			wheel = ( wheel + 1 ) & 7;
+		}
+
+		sievingPrime.index = index - bytes;
+		sievingPrime.wheel = wheel;
+	}
+
+	// Large primes waiting in this segment's bucket, each crosses off once then moves to a later bucket
+	if ( sieve->bucketMask )
+	{
+		u32 page = sieve->buckets[ sieve->segmentNumber & sieve->bucketMask ];
+		sieve->buckets[ sieve->segmentNumber & sieve->bucketMask ] = WHEEL_BUCKET_NO_PAGE;
+
+		while ( page != WHEEL_BUCKET_NO_PAGE )
+		{
+			// Filing can add pages and move the page structs, but not the entries they point at
+			const WheelBucketEntry *entries = sieve->bucketPages[ page ].entries.data();
+			u32 count = sieve->bucketPages[ page ].count;
+			u32 next = sieve->bucketPages[ page ].next;
+
+			for ( u32 i = 0; i < count; ++i )
+			{
+				const WheelBucketEntry &entry = entries[ i ];
+				u64 quotient = entry.prime >> 3;
+				u32 residue = entry.prime & 7;
+				u64 index = entry.index >> 3;
+				u8 wheel = entry.index & 7;
+
+				if ( index < bytes )
+					segment[ index ] &= ~WHEEL_CROSS.crossMask[ residue ][ wheel ];
+
+				index += quotient * WHEEL_STEPS[ wheel ] + WHEEL_CROSS.carry[ residue ][ wheel ];
+				wheel = ( wheel + 1 ) & 7;
+
+				wheel_sieve_file_bucket( sieve, entry.prime, index, wheel );
+			}
+
+			// Emptied, back to the free list for the buckets still filling
+			sieve->bucketPages[ page ].next = sieve->freePage;
+			sieve->freePage = page;
+			page = next;
+		}
+	}
+
+	// Trim the residues outside [from, to) from the first and last bytes
+	if ( lowByte == sieve->from / 30 )
+	{
+		for ( u8 i = 0; i < 8; ++i )
+			if ( WHEEL_OFFSETS[ i ] < sieve->from % 30 )
+				segment[ 0 ] &= static_cast<u8>( ~BIT( i ) );
+	}
+
+	if ( lastSegment )
+	{
+		for ( u8 i = 0; i < 8; ++i )
+			if ( WHEEL_OFFSETS[ i ] > ( sieve->to - 1 ) % 30 )
+				segment[ bytes - 1 ] &= static_cast<u8>( ~BIT( i ) );
+	}
+
+	sieve->lowByte = lowByte + bytes;
+	++sieve->segmentNumber;
+
+	return bytes;
+}
+
+u64 sieve_next_segment( WheelSieve *sieve, u64 *primes )
+{
+	u64 count = 0;
+
+	if ( sieve->smallPrimesPending )
+	{
+		for ( u64 p : { 2, 3, 5 } )
+			if ( p >= sieve->from && p < sieve->to )
+				primes[ count++ ] = p;
+
+		sieve->smallPrimesPending = false;
+	}
+
+	if ( sieve->lowByte >= sieve->highByte )
+		return count;
+
+	u64 base = 30 * sieve->lowByte;
+	u64 bytes = wheel_sieve_segment( sieve );
+	const u8 *segment = sieve->segment.data();
+
+	// Collect, a word at a time
+	u64 i = 0;
+
+	for ( ; i + sizeof( u64 ) <= bytes; i += sizeof( u64 ) )
+	{
+		u64 word;
+		memcpy( &word, segment + i, sizeof( u64 ) );
+
+		while ( word )
+		{
+			u32 bit = count_trailing_zeros( word );
+			primes[ count++ ] = base + 30 * ( i + ( bit >> 3 ) ) + WHEEL_OFFSETS[ bit & 7 ];
+			word &= word - 1;
+		}
+	}
+
+	for ( ; i < bytes; ++i )
+	{
+		u32 bits = segment[ i ];
+
+		while ( bits )
+		{
+			primes[ count++ ] = base + 30 * i + WHEEL_OFFSETS[ count_trailing_zeros( bits ) ];
+			bits &= bits - 1;
+		}
+	}
+
+	return count;
+}
+
+u64 sieve_next_segment_bits( WheelSieve *sieve, const u8 **bits )
+{
+	sieve->smallPrimesPending = false;
+
+	if ( sieve->lowByte >= sieve->highByte )
+	{
+		*bits = nullptr;
+		return 0;
+	}
+
+	*bits = sieve->segment.data();
+
+	return wheel_sieve_segment( sieve );
+}
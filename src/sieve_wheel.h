@@ -0,0 +1,76 @@
+#pragma once
+
+// Mod 30 wheel sieve.
+// Each byte holds the 8 residues coprime to 30 ( 1, 7, 11, 13, 17, 19, 23, 29 ) of 30 consecutive integers as bits.
+// Segments start from a copy of a pre-sieved pattern for 7 - 19, so only primes from 23 up are crossed off.
+#define WHEEL_PRESIEVE_BYTES						( 7 * 11 * 13 * 17 * 19 )
+#define WHEEL_FIRST_SIEVING_PRIME					( 23 )
+#define WHEEL_MIN_SEGMENT_BYTES						( KB( 1 ) )		// keeps the bucket ring under 2^20 buckets up to 2^64
+#define WHEEL_MAX_SEGMENT_BYTES						( 1ull << 29 )
+#define WHEEL_BUCKET_PAGE_MIN_ENTRIES				( 16 )
+#define WHEEL_BUCKET_PAGE_MAX_ENTRIES				( 1024 )
+#define WHEEL_BUCKET_NO_PAGE						( INVALID_INDEX_UINT_32 )
+
+struct WheelSievingPrime
+{
+	u32 quotient;							// p / 30
+	u8 residue;								// wheel index of p % 30
+	u8 wheel;								// wheel index of the multiplier of the next multiple
+	u64 index;								// byte of the next multiple, relative to the next segment
+};
+
+// Sieving primes of at least 30 * segmentBytes hit a segment at most once, so instead of visiting them every
+// segment they wait in the bucket of the segment holding their next multiple (Oliveira e Silva's bucket sieve).
+struct WheelBucketEntry
+{
+	u32 prime;								// p / 30 << 3 | wheel index of p % 30
+	u32 index;								// byte of the next multiple within its segment << 3 | wheel index of the multiplier
+};
+
+// A bucket is a list of fixed size pages, drawn from the free list of the sieve as it fills and given back once its
+// segment has been sieved, so the pages in use follow the entries waiting rather than the busiest segment so far.
+struct WheelBucketPage
+{
+	u32 next;								// next page of the same bucket, or of the free list
+	u32 count;								// entries used
+	std::vector<WheelBucketEntry> entries;	// bucketPageEntries of them
+};
+
+struct WheelSieve
+{
+	static constexpr SieveEngine ENGINE = SIEVE_ENGINE_WHEEL;
+	static constexpr u64 INTEGERS_PER_BYTE = 30;
+
+	u64 from;								// range being sieved [from, to)
+	u64 to;
+	u64 lowByte;							// first byte of the next segment
+	u64 highByte;							// one past the last byte of the range
+	u64 segmentBytes;
+	bool smallPrimesPending;				// 2, 3 and 5 are not on the wheel and still need handing out
+	std::vector<u8> segment;				// set bit = prime
+	SievingPrimes sievingPrimes;			// odd primes up to sqrt( to ) whose square has not been reached
+	std::vector<WheelSievingPrime> activePrimes;	// primes from 23 up whose square has been reached
+	u64 lastSegment;						// number of the segment holding the last byte of the range
+	u64 segmentNumber;						// segments sieved since initialising
+	u64 bucketMask;
+	std::vector<u32> buckets;				// ring of the newest page of each bucket, indexed by segment number
+	std::vector<WheelBucketPage> bucketPages;	// every page, in a bucket or on the free list
+	u32 freePage;							// first page of the free list
+	u32 bucketPageEntries = 0;				// of every page in bucketPages
+};
+
+/// @desc Entries per bucket page for a segment size, smaller segments have more buckets each holding fewer entries
+[[nodiscard]] inline u32 wheel_bucket_page_entries( u64 segmentBytes );
+
+bool sieve_initialise( WheelSieve *sieve, u64 from, u64 to, u64 segmentBytes );
+[[nodiscard]] inline bool sieve_finished( const WheelSieve *sieve );
+[[nodiscard]] inline u64 sieve_segment_capacity( const WheelSieve *sieve );
+
+/// @desc Sieves the next segment and writes the primes found into primes (needs room for sieve_segment_capacity values)
+/// @return Number of primes written
+u64 sieve_next_segment( WheelSieve *sieve, u64 *primes );
+
+/// @desc Sieves the next segment without collecting the primes, bits points at its bytes (valid until the next call)
+/// starting with the byte of 30 * lowByte. 2, 3 and 5 have no bits and are skipped.
+/// @return Number of bytes in bits
+u64 sieve_next_segment_bits( WheelSieve *sieve, const u8 **bits );
@@ -0,0 +1,937 @@
+#define SIQS_MULTIPLIER_PRIMES					( 300 )				// small primes scored for each multiplier
+#define SIQS_MAX_A_FACTORS						( 16 )
+#define SIQS_A_FACTOR_BITS						( 11.5 )			// size of the factors of A aimed for
+#define SIQS_A_TRIES							( 1000 )			// picks of the factors of A before settling for a worse A
+#define SIQS_RESIEVE_FROM_PRIME					( 1024 )			// primes from here on are found dividing a candidate by resieving
+#define SIQS_MAX_CANDIDATES						( 255 )				// per block, numbered in the sieve bytes when resieving
+#define SIQS_MAX_HITS							( 16 )				// resieved primes of a candidate, more than fit a g(x)
+#define SIQS_THRESHOLD_SLACK					( 2.0 )				// bits below the expected size of g(x) past the large prime
+
+// Square free, a square factor would only shrink the factor base
+static constexpr u32 SIQS_MULTIPLIERS[] = { 1, 3, 5, 7, 11, 13, 15, 17, 19, 21, 23, 29, 31, 33, 35, 37, 39, 41, 43, 47, 51, 53, 55, 57, 59, 61, 65, 67, 69, 71, 73 };
+
+struct SiqsPrime
+{
+	u32 prime;
+	u32 root;								// a square root of kN mod prime
+	u8 log;									// log2 of prime, rounded
+	TrialDivisor divisor;					// from SMALL_PRIMES
+};
+
+struct SiqsRelation
+{
+	u128 root;								// Ax + B mod N, its square is the product of the factors (and the large prime) mod N
+	u64 largePrime;							// 1 for none
+	std::vector<u32> factors;				// factor base indices, with repeats
+};
+
+// Shared by the threads, everything above the mutex is read only once collecting starts
+struct Siqs
+{
+	u128 value;
+	u128 kN;
+	std::vector<SiqsPrime> base;			// index 0 is -1, index 1 is 2
+	u32 sieveFrom;							// first base index that is sieved
+	u32 resieveFrom;						// first base index found by resieving rather than trial division
+	u32 halfInterval;						// M
+	u64 largePrimeBound;
+	u8 sieveStart;							// a sieve byte starts here and is a candidate once it reaches 0x80
+	u32 aFactorCount;						// s
+	f64 aBits;								// log2 of the best A, sqrt( 2 kN ) / M
+	u32 poolFrom;							// base indices the first s - 1 factors of A are drawn from
+	u32 poolTo;
+
+	std::mutex mutex;
+	u64 state;								// xorshift choosing the factors of A
+	std::vector<u128> used;					// every A handed out
+	std::vector<SiqsRelation> fulls;
+	std::vector<SiqsRelation> partials;
+	std::vector<u64> largePrimes;			// of the partials, ascending
+	u32 cycles;								// partials with the large prime of an earlier one, each a relation
+	bool done;
+};
+
+// The polynomials of one A, kept by the thread working through them
+struct SiqsPolynomial
+{
+	u128 a;
+	u128 b;									// two's complement, it goes negative
+	u128 c;									// ( B^2 - kN ) / A, negative
+	u32 factors[ SIQS_MAX_A_FACTORS ];		// base indices of the factors of A
+	u128 terms[ SIQS_MAX_A_FACTORS ];		// B is the sum of these with a sign each
+	std::vector<u32> aInverse;				// A^-1 mod p, 0 for the factors of A
+	std::vector<u32> deltas;				// 2 B_l A^-1 mod p, a row of the base per term
+	std::vector<u32> root1;					// x + M mod p at the two roots of g
+	std::vector<u32> root2;
+	std::vector<u32> next1;					// position of the next hit in the current block
+	std::vector<u32> next2;
+};
+
+[[nodiscard]] static inline u32 siqs_mod( u128 value, u32 p )
+{
+	u128 remainder;
+	(void)divide( value, p, &remainder );
+	return static_cast<u32>( remainder.low );
+}
+
+[[nodiscard]] static u32 siqs_power( u64 base, u32 exponent, u32 p )
+{
+	u64 result = 1;
+	base %= p;
+
+	for ( ; exponent; exponent >>= 1 )
+	{
+		if ( exponent & 1 )
+			result = result * base % p;
+
+		base = base * base % p;
+	}
+
+	return static_cast<u32>( result );
+}
+
+/// @desc a^-1 mod p by the extended Euclidean algorithm, a is not a multiple of p
+[[nodiscard]] static u32 siqs_inverse( u32 a, u32 p )
+{
+	i64 x = 0;
+	i64 nextX = 1;
+	u32 r = p;
+	u32 nextR = a % p;
+
+	while ( nextR )
+	{
+		u32 q = r / nextR;
+		i64 t = x - static_cast<i64>( q ) * nextX;
+		x = nextX;
+		nextX = t;
+
+		u32 s = r - q * nextR;
+		r = nextR;
+		nextR = s;
+	}
+
+	return static_cast<u32>( ( x < 0 ) ? x + p : x );
+}
+
+/// @desc A square root of a mod the odd prime p by Tonelli-Shanks, a being a square
+[[nodiscard]] static u32 siqs_square_root( u32 a, u32 p )
+{
+	if ( a == 0 )
+		return 0;
+
+	if ( ( p & 3 ) == 3 )
+		return siqs_power( a, ( p + 1 ) / 4, p );
+
+	// p - 1 = q 2^s, z any non square
+	u32 s = count_trailing_zeros( p - 1 );
+	u32 q = ( p - 1 ) >> s;
+	u32 z = 2;
+
+	while ( siqs_power( z, ( p - 1 ) / 2, p ) != p - 1 )
+		++z;
+
+	u64 c = siqs_power( z, q, p );
+	u64 root = siqs_power( a, ( q + 1 ) / 2, p );
+	u64 t = siqs_power( a, q, p );
+	u32 m = s;
+
+	while ( t != 1 )
+	{
+		// Least i with t^( 2^i ) = 1
+		u32 i = 0;
+		for ( u64 square = t; square != 1; square = square * square % p )
+			++i;
+
+		u64 b = c;
+		for ( u32 j = 0; j + 1 < m - i; ++j )
+			b = b * b % p;
+
+		root = root * b % p;
+		c = b * b % p;
+		t = t * c % p;
+		m = i;
+	}
+
+	return static_cast<u32>( root );
+}
+
+[[nodiscard]] static inline u128 siqs_negate( u128 value )
+{
+	return u128( 0 ) - value;
+}
+
+[[nodiscard]] static inline bool siqs_negative( u128 value )
+{
+	return ( value.high >> 63 ) != 0;
+}
+
+/// @desc Picks the multiplier and builds the factor base and the sieve settings
+/// @return A factor of value when a prime of the base divides it, otherwise 0
+[[nodiscard]] static u128 siqs_initialise( Siqs *siqs, u128 value )
+{
+	siqs->value = value;
+
+	// Knuth-Schroeppel: the expected log contribution of the small primes to a value of g, less half the log of k
+	u32 multiplier = 1;
+	f64 bestScore = -1e30;
+
+	for ( u32 k : SIQS_MULTIPLIERS )
+	{
+		if ( U128_MAX / k < value )
+			break;
+
+		u128 kN = value * k;
+		f64 score = -0.5 * log( static_cast<f64>( k ) );
+
+		switch ( kN.low & 7 )
+		{
+		case 1:		score += 2.0 * log( 2.0 ); break;
+		case 5:		score += log( 2.0 ); break;
+		default:	score += 0.5 * log( 2.0 ); break;
+		}
+
+		for ( u32 i = 0; i < SIQS_MULTIPLIER_PRIMES; ++i )
+		{
+			u32 p = SMALL_PRIMES.primes[ i ];
+			u32 residue = siqs_mod( kN, p );
+			f64 contribution = log( static_cast<f64>( p ) ) / ( p - 1 );
+
+			if ( residue == 0 )
+				score += contribution;
+			else if ( siqs_power( residue, ( p - 1 ) / 2, p ) == 1 )
+				score += 2.0 * contribution;
+		}
+
+		if ( score > bestScore )
+		{
+			bestScore = score;
+			multiplier = k;
+		}
+	}
+
+	siqs->kN = value * multiplier;
+
+	u32 bits = 128 - count_leading_zeros( siqs->kN );
+	const SiqsLevel *level = &SIQS_LEVELS[ SIQS_LEVEL_COUNT - 1 ];
+
+	for ( const SiqsLevel &candidate : SIQS_LEVELS )
+	{
+		if ( bits <= candidate.bits )
+		{
+			level = &candidate;
+			break;
+		}
+	}
+
+	// -1, 2, then the odd primes kN is a square mod (or that divide k)
+	siqs->base.clear();
+	siqs->base.push_back( { 0, 0, 0, {} } );
+	siqs->base.push_back( { 2, 1, 1, {} } );
+
+	for ( u32 i = 0; i < SMALL_PRIMES.COUNT && siqs->base.size() < level->factorBase; ++i )
+	{
+		u32 p = SMALL_PRIMES.primes[ i ];
+
+		if ( siqs_mod( value, p ) == 0 )
+			return p;
+
+		u32 residue = siqs_mod( siqs->kN, p );
+		u8 log = static_cast<u8>( log2( static_cast<f64>( p ) ) + 0.5 );
+
+		if ( residue == 0 )
+			siqs->base.push_back( { p, 0, log, SMALL_PRIMES.divisors[ i ] } );
+		else if ( siqs_power( residue, ( p - 1 ) / 2, p ) == 1 )
+			siqs->base.push_back( { p, siqs_square_root( residue, p ), log, SMALL_PRIMES.divisors[ i ] } );
+	}
+
+	u32 baseSize = static_cast<u32>( siqs->base.size() );
+
+	siqs->sieveFrom = 2;
+	while ( siqs->sieveFrom < baseSize && siqs->base[ siqs->sieveFrom ].prime < SIQS_SIEVE_FROM_PRIME )
+		++siqs->sieveFrom;
+
+	siqs->resieveFrom = siqs->sieveFrom;
+	while ( siqs->resieveFrom < baseSize && siqs->base[ siqs->resieveFrom ].prime < SIQS_RESIEVE_FROM_PRIME )
+		++siqs->resieveFrom;
+
+	siqs->halfInterval = level->blocks * SIQS_BLOCK_BYTES;
+	siqs->largePrimeBound = static_cast<u64>( siqs->base.back().prime ) * level->largePrimeMultiplier;
+
+	// g(x) is about M sqrt( kN / 2 ) at most. The primes that are not sieved would have added about 2 log p / ( p - 1 ),
+	// and 2 about 1.
+	f64 kNBits = log2( static_cast<f64>( siqs->kN.high ) * 18446744073709551616.0 + static_cast<f64>( siqs->kN.low ) );
+	f64 threshold = log2( static_cast<f64>( siqs->halfInterval ) ) + 0.5 * ( kNBits - 1.0 ) - log2( static_cast<f64>( siqs->largePrimeBound ) ) - SIQS_THRESHOLD_SLACK - 1.0;
+
+	for ( u32 i = 2; i < siqs->sieveFrom; ++i )
+		threshold -= 2.0 * siqs->base[ i ].log / ( siqs->base[ i ].prime - 1 );
+
+	siqs->sieveStart = static_cast<u8>( 128 - ( ( threshold < 16.0 ) ? 16 : ( threshold > 127.0 ) ? 127 : static_cast<u32>( threshold ) ) );
+
+	// A near sqrt( 2 kN ) / M, from s primes of about SIQS_A_FACTOR_BITS bits, fewer when the base does not reach them
+	siqs->aBits = 0.5 * ( kNBits + 1.0 ) - log2( static_cast<f64>( siqs->halfInterval ) );
+
+	f64 largestBits = log2( static_cast<f64>( siqs->base.back().prime ) );
+	u32 s = static_cast<u32>( siqs->aBits / SIQS_A_FACTOR_BITS + 0.5 );
+
+	if ( s < 2 )
+		s = 2;
+
+	while ( s < SIQS_MAX_A_FACTORS && siqs->aBits / s > largestBits - 1.0 )
+		++s;
+
+	siqs->aFactorCount = s;
+
+	// The pool spans a factor of 4 around the size aimed for, wide enough for plenty of distinct A
+	f64 factorSize = exp2( siqs->aBits / s );
+	siqs->poolFrom = siqs->sieveFrom;
+	while ( siqs->poolFrom < baseSize - 1 && siqs->base[ siqs->poolFrom ].prime < factorSize / 2.0 )
+		++siqs->poolFrom;
+
+	siqs->poolTo = siqs->poolFrom;
+	while ( siqs->poolTo < baseSize && siqs->base[ siqs->poolTo ].prime < factorSize * 2.0 )
+		++siqs->poolTo;
+
+	while ( siqs->poolTo - siqs->poolFrom < 4 * s && ( siqs->poolFrom > siqs->sieveFrom || siqs->poolTo < baseSize ) )
+	{
+		if ( siqs->poolFrom > siqs->sieveFrom )
+			--siqs->poolFrom;
+
+		if ( siqs->poolTo < baseSize )
+			++siqs->poolTo;
+	}
+
+	siqs->state = 0x9E3779B97F4A7C15ull ^ value.low;
+	siqs->cycles = 0;
+	siqs->done = false;
+
+	return 0;
+}
+
+[[nodiscard]] static inline u64 siqs_random( Siqs *siqs )
+{
+	siqs->state ^= siqs->state << 13;
+	siqs->state ^= siqs->state >> 7;
+	siqs->state ^= siqs->state << 17;
+	return siqs->state;
+}
+
+/// @desc Picks the factors of an A not handed out before, with the mutex held
+static void siqs_choose_a( Siqs *siqs, SiqsPolynomial *polynomial )
+{
+	u32 s = siqs->aFactorCount;
+	u32 poolSize = siqs->poolTo - siqs->poolFrom;
+	u32 baseSize = static_cast<u32>( siqs->base.size() );
+
+	for ( u32 tries = 0; ; ++tries )
+	{
+		// s - 1 random primes of the pool, then the prime that brings A closest to its target
+		u32 chosen = 0;
+		f64 bits = 0.0;
+
+		while ( chosen < s - 1 )
+		{
+			u32 index = siqs->poolFrom + static_cast<u32>( siqs_random( siqs ) % poolSize );
+			bool repeated = ( siqs->base[ index ].root == 0 );
+
+			for ( u32 i = 0; i < chosen; ++i )
+				repeated = repeated || ( polynomial->factors[ i ] == index );
+
+			if ( repeated )
+				continue;
+
+			polynomial->factors[ chosen++ ] = index;
+			bits += log2( static_cast<f64>( siqs->base[ index ].prime ) );
+		}
+
+		f64 wanted = exp2( siqs->aBits - bits );
+		u32 last = 0;
+		f64 bestDistance = 1e30;
+
+		for ( u32 index = siqs->sieveFrom; index < baseSize; ++index )
+		{
+			f64 distance = fabs( static_cast<f64>( siqs->base[ index ].prime ) - wanted );
+			bool repeated = ( siqs->base[ index ].root == 0 );
+
+			for ( u32 i = 0; i < chosen; ++i )
+				repeated = repeated || ( polynomial->factors[ i ] == index );
+
+			if ( !repeated && distance < bestDistance )
+			{
+				bestDistance = distance;
+				last = index;
+			}
+		}
+
+		polynomial->factors[ chosen ] = last;
+		std::sort( polynomial->factors, polynomial->factors + s );
+
+		u128 a = 1;
+		for ( u32 i = 0; i < s; ++i )
+			a *= siqs->base[ polynomial->factors[ i ] ].prime;
+
+		// Off by more than a factor of 2 from the target only once the close ones have run out
+		f64 aBits = log2( static_cast<f64>( a.high ) * 18446744073709551616.0 + static_cast<f64>( a.low ) );
+		bool close = fabs( aBits - siqs->aBits ) < 1.0 || tries >= SIQS_A_TRIES;
+
+		if ( close && std::find( siqs->used.begin(), siqs->used.end(), a ) == siqs->used.end() )
+		{
+			siqs->used.push_back( a );
+			polynomial->a = a;
+			return;
+		}
+	}
+}
+
+/// @desc The terms of B and the inverses of A for the factors just chosen, leaving the first B with every term added
+static void siqs_prepare_a( const Siqs *siqs, SiqsPolynomial *polynomial )
+{
+	u32 s = siqs->aFactorCount;
+	u32 baseSize = static_cast<u32>( siqs->base.size() );
+	u128 a = polynomial->a;
+
+	// B_l = A / q_l * ( t_l ( A / q_l )^-1 mod q_l ), so B_l^2 = kN mod q_l and B_l = 0 mod the other factors
+	polynomial->b = 0;
+
+	for ( u32 l = 0; l < s; ++l )
+	{
+		const SiqsPrime &q = siqs->base[ polynomial->factors[ l ] ];
+		u128 rest = a / q.prime;
+		u32 gamma = static_cast<u32>( static_cast<u64>( q.root ) * siqs_inverse( siqs_mod( rest, q.prime ), q.prime ) % q.prime );
+
+		if ( gamma > q.prime / 2 )
+			gamma = q.prime - gamma;
+
+		polynomial->terms[ l ] = rest * gamma;
+		polynomial->b += polynomial->terms[ l ];
+	}
+
+	polynomial->aInverse.assign( baseSize, 0 );
+	polynomial->deltas.resize( static_cast<u64>( s ) * baseSize );
+	polynomial->root1.resize( baseSize );
+	polynomial->root2.resize( baseSize );
+	polynomial->next1.resize( baseSize );
+	polynomial->next2.resize( baseSize );
+
+	u32 factor = 0;
+
+	for ( u32 i = 2; i < baseSize; ++i )
+	{
+		const SiqsPrime &prime = siqs->base[ i ];
+		u32 p = prime.prime;
+
+		if ( factor < s && polynomial->factors[ factor ] == i )
+		{
+			++factor;
+			continue;
+		}
+
+		u32 inverse = siqs_inverse( siqs_mod( a, p ), p );
+		polynomial->aInverse[ i ] = inverse;
+
+		for ( u32 l = 0; l < s; ++l )
+			polynomial->deltas[ static_cast<u64>( l ) * baseSize + i ] = static_cast<u32>( 2ull * siqs_mod( polynomial->terms[ l ], p ) * inverse % p );
+
+		// x = A^-1 ( +-t - B ), moved along by M
+		u64 b = siqs_mod( polynomial->b, p );
+		u64 shift = siqs->halfInterval % p;
+
+		polynomial->root1[ i ] = static_cast<u32>( ( inverse * ( ( prime.root + p - b ) % p ) + shift ) % p );
+		polynomial->root2[ i ] = static_cast<u32>( ( inverse * ( ( 2ull * p - prime.root - b ) % p ) + shift ) % p );
+	}
+}
+
+/// @desc C of the current B, ( B^2 - kN ) / A which is exact as B^2 = kN mod A
+static inline void siqs_prepare_c( const Siqs *siqs, SiqsPolynomial *polynomial )
+{
+	u128 b = siqs_negative( polynomial->b ) ? siqs_negate( polynomial->b ) : polynomial->b;
+	polynomial->c = siqs_negate( ( siqs->kN - b * b ) / polynomial->a );
+}
+
+/// @desc Moves to the next B of the Gray code, flipping the sign of term v
+static void siqs_next_b( const Siqs *siqs, SiqsPolynomial *polynomial, u32 v, bool subtract )
+{
+	u32 baseSize = static_cast<u32>( siqs->base.size() );
+	const u32 *delta = polynomial->deltas.data() + static_cast<u64>( v ) * baseSize;
+	u128 twice = polynomial->terms[ v ] << 1;
+
+	// The roots are A^-1 ( +-t - B ), so they move the other way to B
+	if ( subtract )
+	{
+		polynomial->b -= twice;
+
+		for ( u32 i = 2; i < baseSize; ++i )
+		{
+			u32 p = siqs->base[ i ].prime;
+			u32 r1 = polynomial->root1[ i ] + delta[ i ];
+			u32 r2 = polynomial->root2[ i ] + delta[ i ];
+			polynomial->root1[ i ] = ( r1 >= p ) ? r1 - p : r1;
+			polynomial->root2[ i ] = ( r2 >= p ) ? r2 - p : r2;
+		}
+	}
+	else
+	{
+		polynomial->b += twice;
+
+		for ( u32 i = 2; i < baseSize; ++i )
+		{
+			u32 p = siqs->base[ i ].prime;
+			u32 r1 = polynomial->root1[ i ];
+			u32 r2 = polynomial->root2[ i ];
+			polynomial->root1[ i ] = ( r1 >= delta[ i ] ) ? r1 - delta[ i ] : r1 + p - delta[ i ];
+			polynomial->root2[ i ] = ( r2 >= delta[ i ] ) ? r2 - delta[ i ] : r2 + p - delta[ i ];
+		}
+	}
+}
+
+/// @desc Offsets of the bytes of a block that reached 0x80
+/// @return How many were written to candidates
+[[nodiscard]] static u32 siqs_scan( const u8 *sieve, u32 *candidates )
+{
+	u32 count = 0;
+
+	for ( u32 i = 0; i < SIQS_BLOCK_BYTES; i += 8 )
+	{
+		u64 word;
+		memcpy( &word, sieve + i, sizeof( word ) );
+
+		for ( u64 mask = word & 0x8080808080808080ull; mask; mask &= mask - 1 )
+			candidates[ count++ ] = i + count_trailing_zeros( mask ) / 8;
+	}
+
+	return count;
+}
+
+#ifdef PLATFORM_AVX2
+[[nodiscard]] static u32 siqs_scan_avx2( const u8 *sieve, u32 *candidates )
+{
+	u32 count = 0;
+
+	for ( u32 i = 0; i < SIQS_BLOCK_BYTES; i += 64 )
+	{
+		// The top bit of each byte, 64 of them at a time as nearly all blocks of 64 hold none
+		__m256i low = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( sieve + i ) );
+		__m256i high = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( sieve + i + 32 ) );
+
+		u64 mask = static_cast<u32>( _mm256_movemask_epi8( low ) ) | ( static_cast<u64>( static_cast<u32>( _mm256_movemask_epi8( high ) ) ) << 32 );
+
+		for ( ; mask; mask &= mask - 1 )
+			candidates[ count++ ] = i + count_trailing_zeros( mask );
+	}
+
+	return count;
+}
+#endif
+
+/// @desc Trial divides g at position j of the interval, keeping it as a full or partial relation. The primes from
+/// resieveFrom on are only tried when they are among the hits, those the resieving found dividing it.
+static void siqs_trial_divide( const Siqs *siqs, const SiqsPolynomial *polynomial, u32 j, const u32 *hits, u32 hitCount, std::vector<SiqsRelation> &fulls, std::vector<SiqsRelation> &partials )
+{
+	i64 x = static_cast<i64>( j ) - siqs->halfInterval;
+	u128 wideX = ( x < 0 ) ? siqs_negate( u128( static_cast<u64>( -x ) ) ) : u128( static_cast<u64>( x ) );
+
+	// g(x) = A x^2 + 2 B x + C, well inside 127 bits so the wrapping arithmetic gives it with its sign
+	u128 root = polynomial->a * wideX + polynomial->b;
+	u128 g = ( root + polynomial->b ) * wideX + polynomial->c;
+
+	bool negative = siqs_negative( g );
+	u128 rest = negative ? siqs_negate( g ) : g;
+
+	if ( rest == 0 )
+		return;
+
+	SiqsRelation relation;
+
+	if ( negative )
+		relation.factors.push_back( 0 );
+
+	u32 twos = count_trailing_zeros( rest );
+	relation.factors.insert( relation.factors.end(), twos, 1 );
+	rest >>= twos;
+
+	auto divide_out = [&] ( u32 index )
+		{
+			const SiqsPrime &prime = siqs->base[ index ];
+
+			if ( rest.high == 0 )
+			{
+				while ( trial_divides( prime.divisor, rest.low ) )
+				{
+					relation.factors.push_back( index );
+					rest.low = trial_divide_exact( prime.divisor, rest.low );
+				}
+
+				return;
+			}
+
+			u128 remainder;
+			u128 quotient = divide( rest, prime.prime, &remainder );
+
+			while ( remainder == 0 )
+			{
+				relation.factors.push_back( index );
+				rest = quotient;
+				quotient = divide( rest, prime.prime, &remainder );
+			}
+		};
+
+	// A prime below resieveFrom divides g exactly when j is at one of its roots
+	for ( u32 i = 2; i < siqs->resieveFrom; ++i )
+	{
+		const SiqsPrime &prime = siqs->base[ i ];
+		u64 offset = static_cast<u64>( j ) + prime.prime;
+
+		if ( polynomial->aInverse[ i ] != 0 && ( trial_divides( prime.divisor, offset - polynomial->root1[ i ] ) || trial_divides( prime.divisor, offset - polynomial->root2[ i ] ) ) )
+			divide_out( i );
+	}
+
+	for ( u32 i = 0; i < hitCount; ++i )
+		divide_out( hits[ i ] );
+
+	// The factors of A only divide g now and then
+	for ( u32 l = 0; l < siqs->aFactorCount; ++l )
+		divide_out( polynomial->factors[ l ] );
+
+	if ( rest != 1 && ( rest.high != 0 || rest.low >= siqs->largePrimeBound ) )
+		return;
+
+	// ( Ax + B )^2 = A g(x) mod N, so A goes into the factors too
+	for ( u32 l = 0; l < siqs->aFactorCount; ++l )
+		relation.factors.push_back( polynomial->factors[ l ] );
+
+	relation.root = ( siqs_negative( root ) ? siqs_negate( root ) : root ) % siqs->value;
+	relation.largePrime = rest.low;
+
+	if ( rest == 1 )
+		fulls.push_back( std::move( relation ) );
+	else
+		partials.push_back( std::move( relation ) );
+}
+
+/// @desc Sieves every B of the current A
+static void siqs_sieve_a( const Siqs *siqs, SiqsPolynomial *polynomial, bool avx2, std::vector<SiqsRelation> &fulls, std::vector<SiqsRelation> &partials )
+{
+	alignas( 64 ) u8 sieve[ SIQS_BLOCK_BYTES ];
+	u32 hits[ SIQS_MAX_CANDIDATES ][ SIQS_MAX_HITS ];
+	u32 hitCounts[ SIQS_MAX_CANDIDATES ];
+
+	u32 baseSize = static_cast<u32>( siqs->base.size() );
+	u32 blocks = 2 * siqs->halfInterval / SIQS_BLOCK_BYTES;
+	u32 polynomials = 1u << ( siqs->aFactorCount - 1 );
+
+	std::vector<u32> candidates( SIQS_BLOCK_BYTES );
+	std::vector<u32> blockStart1( baseSize );
+	std::vector<u32> blockStart2( baseSize );
+
+	for ( u32 index = 0; index < polynomials; ++index )
+	{
+		// Gray code order, B_( s - 1 ) keeps its sign as flipping every sign only negates g
+		if ( index > 0 )
+		{
+			u32 v = count_trailing_zeros( index );
+			u32 gray = index ^ ( index >> 1 );
+			siqs_next_b( siqs, polynomial, v, ( ( gray >> v ) & 1 ) != 0 );
+		}
+
+		siqs_prepare_c( siqs, polynomial );
+
+		for ( u32 i = siqs->sieveFrom; i < baseSize; ++i )
+		{
+			polynomial->next1[ i ] = polynomial->root1[ i ];
+			polynomial->next2[ i ] = polynomial->root2[ i ];
+		}
+
+		for ( u32 block = 0; block < blocks; ++block )
+		{
+			memset( sieve, siqs->sieveStart, SIQS_BLOCK_BYTES );
+			memcpy( blockStart1.data(), polynomial->next1.data(), baseSize * sizeof( u32 ) );
+			memcpy( blockStart2.data(), polynomial->next2.data(), baseSize * sizeof( u32 ) );
+
+			for ( u32 i = siqs->sieveFrom; i < baseSize; ++i )
+			{
+				// The factors of A have no roots to sieve
+				if ( polynomial->aInverse[ i ] == 0 )
+					continue;
+
+				u32 p = siqs->base[ i ].prime;
+				u8 log = siqs->base[ i ].log;
+				u32 position1 = polynomial->next1[ i ];
+				u32 position2 = polynomial->next2[ i ];
+
+				for ( ; position1 < SIQS_BLOCK_BYTES; position1 += p )
+					sieve[ position1 ] += log;
+
+				// A prime dividing k has the one root
+				if ( siqs->base[ i ].root != 0 )
+					for ( ; position2 < SIQS_BLOCK_BYTES; position2 += p )
+						sieve[ position2 ] += log;
+				else
+					position2 = position1;
+
+				polynomial->next1[ i ] = position1 - SIQS_BLOCK_BYTES;
+				polynomial->next2[ i ] = position2 - SIQS_BLOCK_BYTES;
+			}
+
+#ifdef PLATFORM_AVX2
+			u32 count = avx2 ? siqs_scan_avx2( sieve, candidates.data() ) : siqs_scan( sieve, candidates.data() );
+#else
+			u32 count = siqs_scan( sieve, candidates.data() );
+#endif
+
+			if ( count == 0 )
+				continue;
+
+			// Only a threshold far too low gives more, the rest of them are passed over
+			if ( count > SIQS_MAX_CANDIDATES )
+				count = SIQS_MAX_CANDIDATES;
+
+			// Resieving: the block again with each candidate numbered, the larger primes noting the candidates they land on
+			memset( sieve, 0, SIQS_BLOCK_BYTES );
+
+			for ( u32 c = 0; c < count; ++c )
+			{
+				sieve[ candidates[ c ] ] = static_cast<u8>( c + 1 );
+				hitCounts[ c ] = 0;
+			}
+
+			auto note = [&] ( u32 position, u32 i )
+				{
+					u32 c = sieve[ position ] - 1u;
+
+					if ( hitCounts[ c ] < SIQS_MAX_HITS )
+						hits[ c ][ hitCounts[ c ]++ ] = i;
+				};
+
+			for ( u32 i = siqs->resieveFrom; i < baseSize; ++i )
+			{
+				if ( polynomial->aInverse[ i ] == 0 )
+					continue;
+
+				u32 p = siqs->base[ i ].prime;
+
+				for ( u32 position = blockStart1[ i ]; position < SIQS_BLOCK_BYTES; position += p )
+					if ( sieve[ position ] )
+						note( position, i );
+
+				if ( siqs->base[ i ].root != 0 )
+					for ( u32 position = blockStart2[ i ]; position < SIQS_BLOCK_BYTES; position += p )
+						if ( sieve[ position ] )
+							note( position, i );
+			}
+
+			for ( u32 c = 0; c < count; ++c )
+				siqs_trial_divide( siqs, polynomial, block * SIQS_BLOCK_BYTES + candidates[ c ], hits[ c ], hitCounts[ c ], fulls, partials );
+		}
+	}
+}
+
+static void siqs_worker( Siqs *siqs )
+{
+	static const SimdFeatures features = platform_get_simd_features();
+	bool avx2 = ( features & SIMD_FEATURE_AVX2 ) != 0;
+
+	SiqsPolynomial polynomial;
+	std::vector<SiqsRelation> fulls;
+	std::vector<SiqsRelation> partials;
+	std::vector<u64> largePrimes;
+
+	u32 wanted = static_cast<u32>( siqs->base.size() ) + SIQS_EXTRA_RELATIONS;
+
+	for ( ;; )
+	{
+		{
+			std::lock_guard<std::mutex> lock( siqs->mutex );
+
+			if ( siqs->done )
+				return;
+
+			siqs_choose_a( siqs, &polynomial );
+		}
+
+		siqs_prepare_a( siqs, &polynomial );
+		siqs_sieve_a( siqs, &polynomial, avx2, fulls, partials );
+
+		largePrimes.clear();
+		for ( const SiqsRelation &relation : partials )
+			largePrimes.push_back( relation.largePrime );
+
+		std::sort( largePrimes.begin(), largePrimes.end() );
+
+		std::lock_guard<std::mutex> lock( siqs->mutex );
+
+		// Each partial with a large prime seen before closes a cycle, one more relation once they are combined
+		for ( u64 i = 0; i < largePrimes.size(); ++i )
+			if ( ( i > 0 && largePrimes[ i ] == largePrimes[ i - 1 ] ) || std::binary_search( siqs->largePrimes.begin(), siqs->largePrimes.end(), largePrimes[ i ] ) )
+				++siqs->cycles;
+
+		u64 middle = siqs->largePrimes.size();
+		siqs->largePrimes.insert( siqs->largePrimes.end(), largePrimes.begin(), largePrimes.end() );
+		std::inplace_merge( siqs->largePrimes.begin(), siqs->largePrimes.begin() + middle, siqs->largePrimes.end() );
+
+		for ( SiqsRelation &relation : fulls )
+			siqs->fulls.push_back( std::move( relation ) );
+
+		for ( SiqsRelation &relation : partials )
+			siqs->partials.push_back( std::move( relation ) );
+
+		fulls.clear();
+		partials.clear();
+
+		if ( siqs->fulls.size() + siqs->cycles >= wanted )
+			siqs->done = true;
+	}
+}
+
+/// @desc Combines the relations into squares and tries each for a factor
+/// @return A factor, 0 when every square gave X = +-Y
+[[nodiscard]] static u128 siqs_solve( Siqs *siqs )
+{
+	Montgomery128 montgomery;
+	montgomery_initialise( &montgomery, siqs->value );
+
+	u32 baseSize = static_cast<u32>( siqs->base.size() );
+	std::vector<SiqsRelation> relations = std::move( siqs->fulls );
+
+	// Partials sharing a large prime pair up with the first of them, L^2 joining the square
+	std::sort( siqs->partials.begin(), siqs->partials.end(), [] ( const SiqsRelation &lhs, const SiqsRelation &rhs ) { return lhs.largePrime < rhs.largePrime; } );
+
+	for ( u64 first = 0, i = 1; i < siqs->partials.size(); ++i )
+	{
+		const SiqsRelation &partial = siqs->partials[ i ];
+
+		if ( partial.largePrime != siqs->partials[ first ].largePrime )
+		{
+			first = i;
+			continue;
+		}
+
+		const SiqsRelation &pair = siqs->partials[ first ];
+		SiqsRelation relation;
+
+		relation.root = montgomery_from( &montgomery, montgomery_multiply( &montgomery, montgomery_to( &montgomery, pair.root ), montgomery_to( &montgomery, partial.root ) ) );
+		relation.largePrime = partial.largePrime;
+		relation.factors = pair.factors;
+		relation.factors.insert( relation.factors.end(), partial.factors.begin(), partial.factors.end() );
+
+		relations.push_back( std::move( relation ) );
+	}
+
+	if ( relations.size() > baseSize + SIQS_EXTRA_RELATIONS )
+		relations.resize( baseSize + SIQS_EXTRA_RELATIONS );
+
+	// A row per relation: the parity of each exponent, then a bit of its own to track which relations were added in
+	u32 rows = static_cast<u32>( relations.size() );
+	u32 matrixWords = ( baseSize + 63 ) / 64;
+	u32 words = matrixWords + ( rows + 63 ) / 64;
+	std::vector<u64> matrix( static_cast<u64>( rows ) * words, 0 );
+
+	for ( u32 r = 0; r < rows; ++r )
+	{
+		u64 *row = &matrix[ static_cast<u64>( r ) * words ];
+
+		for ( u32 index : relations[ r ].factors )
+			row[ index / 64 ] ^= 1ull << ( index % 64 );
+
+		row[ matrixWords + r / 64 ] |= 1ull << ( r % 64 );
+	}
+
+	// Gaussian elimination, the rows left with no matrix bits are the squares
+	u32 rank = 0;
+
+	for ( u32 column = 0; column < baseSize && rank < rows; ++column )
+	{
+		u32 word = column / 64;
+		u64 bit = 1ull << ( column % 64 );
+		u32 pivot = rank;
+
+		while ( pivot < rows && !( matrix[ static_cast<u64>( pivot ) * words + word ] & bit ) )
+			++pivot;
+
+		if ( pivot == rows )
+			continue;
+
+		u64 *pivotRow = &matrix[ static_cast<u64>( pivot ) * words ];
+		u64 *rankRow = &matrix[ static_cast<u64>( rank ) * words ];
+
+		if ( pivot != rank )
+			std::swap_ranges( pivotRow, pivotRow + words, rankRow );
+
+		for ( u32 r = rank + 1; r < rows; ++r )
+		{
+			u64 *row = &matrix[ static_cast<u64>( r ) * words ];
+
+			if ( row[ word ] & bit )
+				for ( u32 w = word; w < words; ++w )
+					row[ w ] ^= rankRow[ w ];
+		}
+
+		++rank;
+	}
+
+	std::vector<u32> exponents( baseSize );
+
+	for ( u32 r = rank; r < rows; ++r )
+	{
+		const u64 *row = &matrix[ static_cast<u64>( r ) * words ];
+		u128 x = montgomery.one;
+		u128 y = montgomery.one;
+
+		std::fill( exponents.begin(), exponents.end(), 0 );
+
+		for ( u32 i = 0; i < rows; ++i )
+		{
+			if ( !( row[ matrixWords + i / 64 ] & ( 1ull << ( i % 64 ) ) ) )
+				continue;
+
+			const SiqsRelation &relation = relations[ i ];
+			x = montgomery_multiply( &montgomery, x, montgomery_to( &montgomery, relation.root ) );
+
+			if ( relation.largePrime != 1 )
+				y = montgomery_multiply( &montgomery, y, montgomery_to( &montgomery, relation.largePrime ) );
+
+			for ( u32 index : relation.factors )
+				++exponents[ index ];
+		}
+
+		// Index 0 is -1, which an even exponent leaves out
+		for ( u32 index = 1; index < baseSize; ++index )
+		{
+			massert( ( exponents[ index ] & 1 ) == 0 );
+
+			if ( exponents[ index ] )
+				y = montgomery_multiply( &montgomery, y, montgomery_power( &montgomery, montgomery_to( &montgomery, siqs->base[ index ].prime ), exponents[ index ] / 2 ) );
+		}
+
+		x = montgomery_from( &montgomery, x );
+		y = montgomery_from( &montgomery, y );
+
+		u128 divisor = greatest_common_divisor( ( x > y ) ? x - y : y - x, siqs->value );
+
+		if ( divisor != 1 && divisor != siqs->value )
+			return divisor;
+	}
+
+	return 0;
+}
+
+u128 siqs_find_factor( u128 value, u32 threadCount )
+{
+	massert( ( value.low & 1 ) && value > 1 );
+
+	Siqs siqs;
+	u128 factor = siqs_initialise( &siqs, value );
+
+	if ( factor != 0 )
+		return factor;
+
+	std::vector<std::thread> workers;
+
+	for ( u32 i = 1; i < threadCount; ++i )
+		workers.emplace_back( siqs_worker, &siqs );
+
+	siqs_worker( &siqs );
+
+	for ( std::thread &worker : workers )
+		worker.join();
+
+	return siqs_solve( &siqs );
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Self-initialising quadratic sieve, for the 128 bit cofactors made of two large primes of about the same size.
+// kN, with k a small multiplier picked for the small primes it makes squares, gives the factor base: -1, 2 and the odd
+// primes of SMALL_PRIMES that kN is a square mod. Each polynomial g(x) = ( ( Ax + B )^2 - kN ) / A is sieved over
+// -M <= x < M in blocks that fit the L1 cache, the log of each prime added at its two roots, and only the x whose
+// byte reaches 0x80 are trial divided (found 32 bytes at a time with AVX2). A is a product of s factor base primes
+// and each A has 2^(s-1) values of B, the roots of the next B are one addition per prime away (the self-initialising).
+// ( Ax + B )^2 = A g(x) mod N is a relation when g(x) factors over the base, or when all that is left is one prime
+// below the large prime bound, two of those with the same large prime making a relation between them.
+// With more relations than primes, Gaussian elimination over GF(2) finds sets whose product is a square on both
+// sides, X^2 = Y^2 mod N, and each set has a 1 in 2 chance of gcd( X - Y, N ) being a factor.
+// The threads collect relations an A at a time each.
+#define SIQS_BLOCK_BYTES						( 32 * 1024 )
+#define SIQS_SIEVE_FROM_PRIME					( 32 )				// primes below are not sieved, only trial divided
+#define SIQS_EXTRA_RELATIONS					( 64 )				// relations past the size of the factor base
+#define SIQS_LEVEL_COUNT						( 7 )
+
+struct SiqsLevel
+{
+	u32 bits;								// of kN, up to
+	u32 factorBase;							// primes in the factor base
+	u32 blocks;								// of the sieve each side of 0, M is this many SIQS_BLOCK_BYTES
+	u32 largePrimeMultiplier;				// the large prime bound is the largest prime of the base times this
+};
+
+// Sizes timed on balanced semiprimes, each level taking the kN up to its bits
+inline constexpr SiqsLevel SIQS_LEVELS[ SIQS_LEVEL_COUNT ] =
+{
+	{ 80, 120, 1, 30 },
+	{ 90, 200, 1, 30 },
+	{ 100, 300, 1, 40 },
+	{ 110, 500, 1, 40 },
+	{ 116, 700, 1, 50 },
+	{ 122, 900, 2, 50 },
+	{ 128, 1200, 2, 60 },
+};
+
+/// @desc Finds a factor of an odd composite value that is not a perfect power, with up to threadCount threads
+/// collecting relations
+/// @return A factor between 1 and value (exclusive), 0 when the relations gave none
+[[nodiscard]] u128 siqs_find_factor( u128 value, u32 threadCount );
@@ -27,15 +27,74 @@
 
 	while ( ( *input >= '0' && *input <= '9' ) )
 	{
-		overflow = overflow || base > ( SIZE_MAX / 10 ) || ( base == ( SIZE_MAX / 10 ) && ( *input - '0' ) > 7 );
+		overflow = overflow || base > ( SIZE_MAX / 10 ) || ( base == ( SIZE_MAX / 10 ) && static_cast<u64>( *input - '0' ) > SIZE_MAX % 10 );
 
 		base = 10 * base + ( *input++ - '0' );
 	}
 
+	// Like an invalid input nothing is read, clamping would quietly turn the number into a different one
+	if ( overflow )
+	{
+		show_log_warning( "Invalid data. Too large for an u64." );
+		if ( output )
+			*output = start;
+		return 0;
+	}
+
+	if ( output )
+		*output = input;
+
+	return base;
+}
+
+[[nodiscard]] u128 convert_to_u128( const char *input, const char **output )
+{
+	const char *start = input;
+
+	// remove leading whitespace
+	while ( *input == ' ' )
+		++input;
+
+	// check it's a number or invalid input
+	if ( ( *input < '0' || *input > '9' ) && *input != '+' )
+	{
+		show_log_warning( "Invalid data. Not an u128." );
+		if ( output )
+			*output = start;
+		return 0;
+	}
+
+	if ( *input == '+' )
+		++input;
+
+	constexpr u128 LIMIT = u128( UINT64_MAX / 10, 0x9999999999999999ull );	// U128_MAX / 10, which ends in 5
+
+	u128 base = 0;
+
+	bool overflow = false;
+
+	while ( ( *input >= '0' && *input <= '9' ) )
+	{
+		u64 digit = *input++ - '0';
+
+		overflow = overflow || base > LIMIT || ( base == LIMIT && digit > 5 );
+
+		base = base * 10 + digit;
+	}
+
+	// Like an invalid input nothing is read, clamping would quietly turn the number into a different one
+	if ( overflow )
+	{
+		show_log_warning( "Invalid data. Too large for an u128." );
+		if ( output )
+			*output = start;
+		return 0;
+	}
+
 	if ( output )
 		*output = input;
 
-	return !overflow ? base : SIZE_MAX;
+	return base;
 }
 
 [[nodiscard]] i64 convert_to_i64( const char *input, const char **output )
@@ -234,6 +293,51 @@ u64 convert_to_string( char *dest, u64 destSize, u64 value, i32 radix, i32 trail
 	return len;
 }
 
+u64 convert_to_string( char *dest, u64 destSize, u128 value, i32 radix, i32 trailing )
+{
+	massert( radix <= 256 );
+	massert( trailing <= 32 );
+
+	char tmp[ 128 ];
+	char *tp = tmp;
+
+	char i;
+
+	while ( value != 0 || tp == tmp )
+	{
+		// The high half first, its remainder leads into the low half
+		u64 rem = value.high % radix;
+		value.high /= radix;
+		value.low = divide_128( rem, value.low, radix, &rem );
+
+		i = static_cast<char>( rem );
+
+		if ( i < 10 )
+			*tp++ = i + '0';
+		else
+			*tp++ = i + 'a' - 10;
+	}
+
+	u64 len = tp - tmp;
+
+	// Check if trailing 0's are needed
+	while ( len < trailing )
+	{
+		*tp++ = '0';
+		++len;
+	}
+
+	massert( destSize + 1 >= len );
+
+	while ( tp > tmp )
+		*dest++ = *--tp;
+
+	*dest = '\0';
+
+	// Digits of string
+	return len;
+}
+
 u64 convert_to_string( char *dest, u64 destSize, i64 value, i32 radix, i32 trailing )
 {
 	massert( radix <= 256 );
@@ -359,6 +463,14 @@ u64 convert_to_string( char *dest, u64 destSize, bool value )
 	return text;
 }
 
+[[nodiscard]] const char *convert_to_string( u128 value, i32 radix, i32 trailing )
+{
+	char *text = (char *)memory_arena_transient_allocate( &program->memoryArena, MAX_CONVERT_TO_STRING_DIGITS_128 );
+	convert_to_string( text, MAX_CONVERT_TO_STRING_DIGITS_128, value, radix, trailing );
+	text = (char *)memory_arena_transient_reallocate( &program->memoryArena, text, string_utf8_bytes( text ) );
+	return text;
+}
+
 [[nodiscard]] const char *convert_to_string( i8 value, i32 radix, i32 trailing )
 {
 	char *text = (char *)memory_arena_transient_allocate( &program->memoryArena, MAX_CONVERT_TO_STRING_DIGITS );
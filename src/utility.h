@@ -3,15 +3,142 @@
 
 #define ID_NAME( id )	id, #id
 
-[[nodiscard ]] inline bool is_prime( u64 value )
+[[nodiscard]] inline u64 integer_sqrt( u64 value )
 {
-	u64 sqrRoot = (u64)sqrt( value );
+	u64 root = static_cast<u64>( sqrt( static_cast<f64>( value ) ) );
 
-	for ( u64 i = 3; i <= sqrRoot; i += 2 )
-		if ( value % i == 0 )
-			return false;
+	// The double rounding can be off by one either way for large values
+	if ( root > UINT32_MAX )
+		root = UINT32_MAX;
 
-	return true;
+	while ( root * root > value )
+		--root;
+
+	while ( root < UINT32_MAX && ( root + 1 ) * ( root + 1 ) <= value )
+		++root;
+
+	return root;
+}
+
+[[nodiscard]] inline u64 integer_cbrt( u64 value )
+{
+	u64 root = static_cast<u64>( cbrt( static_cast<f64>( value ) ) );
+
+	// 2642245^3 is the largest cube below 2^64
+	if ( root > 2642245 )
+		root = 2642245;
+
+	while ( root * root * root > value )
+		--root;
+
+	while ( root < 2642245 && ( root + 1 ) * ( root + 1 ) * ( root + 1 ) <= value )
+		++root;
+
+	return root;
+}
+
+[[nodiscard]] inline u32 count_set_bits( u64 value )
+{
+#ifdef _MSC_VER
+	return static_cast<u32>( __popcnt64( value ) );
+#else
+	return __builtin_popcountll( value );
+#endif
+}
+
+[[nodiscard]] inline u32 count_trailing_zeros( u64 value )
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64( &index, value );
+	return index;
+#else
+	return __builtin_ctzll( value );
+#endif
+}
+
+[[nodiscard]] inline u32 count_leading_zeros( u64 value )
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64( &index, value );
+	return 63 - index;
+#else
+	return __builtin_clzll( value );
+#endif
+}
+
+/// @desc Set bits across size bytes, a word at a time
+[[nodiscard]] inline u64 count_set_bits( const u8 *bytes, u64 size )
+{
+	u64 count = 0;
+	u64 i = 0;
+
+	for ( ; i + sizeof( u64 ) <= size; i += sizeof( u64 ) )
+	{
+		u64 word;
+		memcpy( &word, bytes + i, sizeof( u64 ) );
+		count += count_set_bits( word );
+	}
+
+	for ( ; i < size; ++i )
+		count += count_set_bits( bytes[ i ] );
+
+	return count;
+}
+
+/// @desc Full 128 bit product of a and b
+/// @return The low 64 bits, the high 64 bits are written to high
+[[nodiscard]] inline u64 multiply_128( u64 a, u64 b, u64 *high )
+{
+#ifdef _MSC_VER
+	return _umul128( a, b, high );
+#else
+	unsigned __int128 product = static_cast<unsigned __int128>( a ) * b;
+	*high = static_cast<u64>( product >> 64 );
+	return static_cast<u64>( product );
+#endif
+}
+
+/// @desc a + b + carry, the carry out is written back to carry
+[[nodiscard]] inline u64 add_with_carry( u64 a, u64 b, u8 *carry )
+{
+#ifdef _MSC_VER
+	unsigned long long sum;
+	*carry = _addcarry_u64( *carry, a, b, &sum );
+	return sum;
+#else
+	unsigned __int128 sum = static_cast<unsigned __int128>( a ) + b + *carry;
+	*carry = static_cast<u8>( sum >> 64 );
+	return static_cast<u64>( sum );
+#endif
+}
+
+/// @desc a - b - borrow, the borrow out is written back to borrow
+[[nodiscard]] inline u64 subtract_with_borrow( u64 a, u64 b, u8 *borrow )
+{
+#ifdef _MSC_VER
+	unsigned long long difference;
+	*borrow = _subborrow_u64( *borrow, a, b, &difference );
+	return difference;
+#else
+	unsigned __int128 difference = static_cast<unsigned __int128>( a ) - b - *borrow;
+	*borrow = static_cast<u8>( ( difference >> 64 ) & 1 );
+	return static_cast<u64>( difference );
+#endif
+}
+
+/// @desc The 128 bit value high:low divided by divisor, high has to be below divisor so the quotient fits
+/// @return The quotient, the remainder is written to remainder
+[[nodiscard]] inline u64 divide_128( u64 high, u64 low, u64 divisor, u64 *remainder )
+{
+#ifdef _MSC_VER
+	return _udiv128( high, low, divisor, remainder );
+#else
+	unsigned __int128 value = ( static_cast<unsigned __int128>( high ) << 64 ) | low;
+	*remainder = static_cast<u64>( value % divisor );
+	return static_cast<u64>( value / divisor );
+#endif
 }
 
 [[nodiscard ]] inline bool bytes_compare( const void *rhs, const void *lhs, u64 bytes )
@@ -71,6 +198,24 @@ inline void write_data( u8 *&dst, const void *src, u64 size, u8 *dstBarrier )
 	dst += size;
 }
 
+/// @desc Formats a line of up to 256 bytes and writes it to the file. written goes false when a line fails and the
+/// lines after it are skipped, so a text file can be written line by line and checked once at the end
+inline void write_file_line( u32 fileID, bool *written, const char *format, ... )
+{
+	if ( !*written )
+		return;
+
+	char line[ 256 ];
+
+	va_list args;
+	va_start( args, format );
+	i32 length = string_utf8_format_args( line, format, args );
+	va_end( args );
+
+	*written = length > 0 && platform_write_to_file( fileID, line, length ) == static_cast<u64>( length );
+}
+
+/// @desc Reads a decimal number, 0 with output left at input when there is none or it is too large for a u64
 [[nodiscard]] u64 convert_to_u64( const char *input, const char **output = nullptr );
 
 [[nodiscard]] inline u32 convert_to_u32( const char *input, const char **output = nullptr )